@@ -0,0 +1,372 @@
+/*
+   Host micro-benchmarks of the scheduler, list and task primitives.
+
+   Each benchmark is run in batches until the minimum time has passed,
+   the result is the mean time per operation. The results are written as
+   JSON so they can be tracked over time.
+
+   usage: benchmarks [-o FILE] [--min-time-ms N] [--filter TEXT]
+
+   SPDX-License-Identifier: Unlicense
+
+   https://five-embeddev.com/
+
+*/
+
+#include <chrono>
+#include <coroutine>
+#include <cstdint>
+#include <cstdio>
+#include <cstdlib>
+#include <cstring>
+#include <ctime>
+#include <vector>
+
+#include "coro/scheduler.hpp"
+#include "coro/awaitable_unordered.hpp"
+
+namespace {
+
+    /** Number of lists or schedulers filled and drained in each timed batch,
+        so the clock is read once per BATCH * MAX_TASKS operations. */
+    constexpr std::size_t BATCH = 64;
+
+    /** Result of one benchmark. */
+    struct bench_result {
+        const char* name;
+        std::size_t size;
+        std::uint64_t ops;
+        double ns_per_op;
+    };
+
+    /** Command line options. */
+    struct bench_options {
+        const char* output{ nullptr };
+        const char* filter{ nullptr };
+        std::chrono::milliseconds min_time{ 200 };
+    };
+
+    /** Test if a benchmark matches the --filter option. */
+    bool selected(const bench_options& options, const char* name) {
+        return !options.filter || std::strstr(name, options.filter);
+    }
+
+    /** Stop the compiler removing the benchmarked work. */
+    inline void clobber(void) {
+        __asm__ volatile("" : : : "memory");
+    }
+
+    /** Priorities spread over the list, from a fixed sequence so runs are comparable. */
+    int priority_sequence(std::size_t i) {
+        return static_cast<int>((i * 2654435761u) >> 24) & 0x3F;
+    }
+
+    /** Co-routine used to benchmark the frame and scheduler round trips.
+
+        nop_task is not used, its frames come from a bump allocator that is never freed,
+        and it logs each state change on the host.
+     */
+    struct bench_task {
+        struct promise_type {
+            bench_task get_return_object() {
+                return {};
+            }
+            std::suspend_never initial_suspend() {
+                return {};
+            }
+            std::suspend_never final_suspend() noexcept {
+                return {};
+            }
+            void return_void() {}
+            void unhandled_exception() {}
+        };
+    };
+
+    bench_task empty_coro(volatile unsigned int& count) {
+        count = count + 1;
+        co_return;
+    }
+
+    /** Alternate between two schedulers, scheduler_unordered::resume() runs until its list is empty. */
+    template<std::size_t MAX_TASKS>
+    bench_task yield_coro(scheduler_unordered<MAX_TASKS>& a, scheduler_unordered<MAX_TASKS>& b, const bool& stop) {
+        while (!stop) {
+            co_await a;
+            co_await b;
+        }
+    }
+
+    /** Run fn(rounds) until min_time has passed.
+        @param fn         Runs the given rounds, returns the time it took and the operations done.
+        @retval  The result, name and size are set by the caller.
+     */
+    template<typename FN>
+    bench_result measure(const bench_options& options, FN fn) {
+        std::uint64_t rounds{ 1 };
+        while (true) {
+            const auto [elapsed, ops] = fn(rounds);
+            if (elapsed >= options.min_time || rounds >= (1ull << 40)) {
+                const auto ns = std::chrono::duration<double, std::nano>(elapsed).count();
+                return { "", 0, ops, ns / static_cast<double>(ops) };
+            }
+            // Aim past min_time in the next run.
+            const auto ns = std::chrono::duration_cast<std::chrono::nanoseconds>(elapsed).count();
+            const auto target = std::chrono::duration_cast<std::chrono::nanoseconds>(options.min_time).count();
+            const auto scale = (ns > 0) ? (target * 3 / 2) / ns + 1 : 10;
+            rounds *= static_cast<std::uint64_t>(scale < 2 ? 2 : scale > 100 ? 100
+                                                                                : scale);
+        }
+    }
+
+    using bench_clock = std::chrono::steady_clock;
+    using bench_timing = std::pair<bench_clock::duration, std::uint64_t>;
+
+    /** static_list emplace at a spread of positions, then erase from the front.
+     */
+    template<std::size_t MAX_TASKS>
+    void bench_static_list(const bench_options& options, std::vector<bench_result>& results) {
+        if (!selected(options, "static_list/emplace") && !selected(options, "static_list/erase")) {
+            return;
+        }
+        std::vector<static_list<int, MAX_TASKS>> lists(BATCH);
+        bench_clock::duration emplace_time{};
+        bench_clock::duration erase_time{};
+
+        auto run = [&](std::uint64_t rounds) {
+            emplace_time = {};
+            erase_time = {};
+            for (std::uint64_t r = 0; r < rounds; r++) {
+                auto start = bench_clock::now();
+                for (auto& list : lists) {
+                    for (std::size_t i = 0; i < MAX_TASKS; i++) {
+                        // Alternate the back and the front.
+                        list.emplace((i & 1) ? list.begin() : list.end(), static_cast<int>(i));
+                    }
+                }
+                clobber();
+                auto mid = bench_clock::now();
+                for (auto& list : lists) {
+                    for (std::size_t i = 0; i < MAX_TASKS; i++) {
+                        list.erase(list.begin());
+                    }
+                }
+                clobber();
+                auto end = bench_clock::now();
+                emplace_time += mid - start;
+                erase_time += end - mid;
+            }
+            return bench_timing{ emplace_time + erase_time, rounds * BATCH * MAX_TASKS };
+        };
+        const auto total = measure(options, run);
+        const auto ops = total.ops;
+        results.push_back({ "static_list/emplace", MAX_TASKS, ops,
+                            std::chrono::duration<double, std::nano>(emplace_time).count() / static_cast<double>(ops) });
+        results.push_back({ "static_list/erase", MAX_TASKS, ops,
+                            std::chrono::duration<double, std::nano>(erase_time).count() / static_cast<double>(ops) });
+    }
+
+    /** scheduler_ordered insert in priority order, then resume until empty.
+        The handles are no-op co-routines so only the scheduler is measured.
+     */
+    template<std::size_t MAX_TASKS>
+    void bench_scheduler_ordered(const bench_options& options, std::vector<bench_result>& results) {
+        if (!selected(options, "scheduler_ordered/insert") && !selected(options, "scheduler_ordered/resume")) {
+            return;
+        }
+        using SCHEDULER = scheduler_ordered<schedule_by_priority, MAX_TASKS>;
+        std::vector<SCHEDULER> schedulers(BATCH);
+        const std::coroutine_handle<> handle = std::noop_coroutine();
+        std::array<schedule_by_priority, MAX_TASKS> priorities;
+        for (std::size_t i = 0; i < MAX_TASKS; i++) {
+            priorities[i] = schedule_by_priority{ priority_sequence(i) };
+        }
+        const schedule_by_priority lowest{ 0 };
+        bench_clock::duration insert_time{};
+        bench_clock::duration resume_time{};
+
+        auto run = [&](std::uint64_t rounds) {
+            insert_time = {};
+            resume_time = {};
+            for (std::uint64_t r = 0; r < rounds; r++) {
+                auto start = bench_clock::now();
+                for (auto& scheduler : schedulers) {
+                    for (const auto& priority : priorities) {
+                        scheduler.insert(handle, priority);
+                    }
+                }
+                clobber();
+                auto mid = bench_clock::now();
+                for (auto& scheduler : schedulers) {
+                    while (scheduler.resume(lowest).first) {
+                    }
+                }
+                clobber();
+                auto end = bench_clock::now();
+                insert_time += mid - start;
+                resume_time += end - mid;
+            }
+            return bench_timing{ insert_time + resume_time, rounds * BATCH * MAX_TASKS };
+        };
+        const auto total = measure(options, run);
+        const auto ops = total.ops;
+        results.push_back({ "scheduler_ordered/insert", MAX_TASKS, ops,
+                            std::chrono::duration<double, std::nano>(insert_time).count() / static_cast<double>(ops) });
+        results.push_back({ "scheduler_ordered/resume", MAX_TASKS, ops,
+                            std::chrono::duration<double, std::nano>(resume_time).count() / static_cast<double>(ops) });
+    }
+
+    /** scheduler_unordered insert, then resume all.
+     */
+    template<std::size_t MAX_TASKS>
+    void bench_scheduler_unordered(const bench_options& options, std::vector<bench_result>& results) {
+        if (!selected(options, "scheduler_unordered/insert") && !selected(options, "scheduler_unordered/resume")) {
+            return;
+        }
+        using SCHEDULER = scheduler_unordered<MAX_TASKS>;
+        std::vector<SCHEDULER> schedulers(BATCH);
+        const std::coroutine_handle<> handle = std::noop_coroutine();
+        bench_clock::duration insert_time{};
+        bench_clock::duration resume_time{};
+
+        auto run = [&](std::uint64_t rounds) {
+            insert_time = {};
+            resume_time = {};
+            for (std::uint64_t r = 0; r < rounds; r++) {
+                auto start = bench_clock::now();
+                for (auto& scheduler : schedulers) {
+                    for (std::size_t i = 0; i < MAX_TASKS; i++) {
+                        scheduler.insert(handle);
+                    }
+                }
+                clobber();
+                auto mid = bench_clock::now();
+                for (auto& scheduler : schedulers) {
+                    scheduler.resume();
+                }
+                clobber();
+                auto end = bench_clock::now();
+                insert_time += mid - start;
+                resume_time += end - mid;
+            }
+            return bench_timing{ insert_time + resume_time, rounds * BATCH * MAX_TASKS };
+        };
+        const auto total = measure(options, run);
+        const auto ops = total.ops;
+        results.push_back({ "scheduler_unordered/insert", MAX_TASKS, ops,
+                            std::chrono::duration<double, std::nano>(insert_time).count() / static_cast<double>(ops) });
+        results.push_back({ "scheduler_unordered/resume", MAX_TASKS, ops,
+                            std::chrono::duration<double, std::nano>(resume_time).count() / static_cast<double>(ops) });
+    }
+
+    /** Create a co-routine that runs to completion, its frame is allocated and freed.
+     */
+    void bench_coro_create(const bench_options& options, std::vector<bench_result>& results) {
+        if (!selected(options, "coroutine/create_destroy")) {
+            return;
+        }
+        volatile unsigned int count{ 0 };
+        auto run = [&](std::uint64_t rounds) {
+            auto start = bench_clock::now();
+            for (std::uint64_t r = 0; r < rounds; r++) {
+                empty_coro(count);
+            }
+            return bench_timing{ bench_clock::now() - start, rounds };
+        };
+        auto result = measure(options, run);
+        result.name = "coroutine/create_destroy";
+        results.push_back(result);
+    }
+
+    /** Suspend on a scheduler_unordered and resume from it, one co-routine.
+     */
+    void bench_suspend_resume(const bench_options& options, std::vector<bench_result>& results) {
+        if (!selected(options, "coroutine/suspend_resume")) {
+            return;
+        }
+        scheduler_unordered<1> a;
+        scheduler_unordered<1> b;
+        bool stop{ false };
+        yield_coro(a, b, stop);
+        auto run = [&](std::uint64_t rounds) {
+            auto start = bench_clock::now();
+            for (std::uint64_t r = 0; r < rounds; r++) {
+                a.resume();
+                b.resume();
+            }
+            return bench_timing{ bench_clock::now() - start, 2 * rounds };
+        };
+        auto result = measure(options, run);
+        result.name = "coroutine/suspend_resume";
+        results.push_back(result);
+        // Let the co-routine complete, so its frame is freed.
+        stop = true;
+        a.resume();
+    }
+
+    template<std::size_t... MAX_TASKS>
+    void bench_sizes(const bench_options& options, std::vector<bench_result>& results) {
+        (bench_static_list<MAX_TASKS>(options, results), ...);
+        (bench_scheduler_ordered<MAX_TASKS>(options, results), ...);
+        (bench_scheduler_unordered<MAX_TASKS>(options, results), ...);
+    }
+
+    void write_json(FILE* out, const std::vector<bench_result>& results) {
+        const std::time_t now = std::time(nullptr);
+        char date[32];
+        std::strftime(date, sizeof(date), "%Y-%m-%dT%H:%M:%SZ", std::gmtime(&now));
+        fprintf(out, "{\n");
+        fprintf(out, "  \"context\": { \"date\": \"%s\", \"compiler\": \"%s\" },\n", date, __VERSION__);
+        fprintf(out, "  \"benchmarks\": [\n");
+        for (std::size_t i = 0; i < results.size(); i++) {
+            const auto& r = results[i];
+            fprintf(out, "    { \"name\": \"%s\", \"max_tasks\": %zu, \"ops\": %llu, \"ns_per_op\": %.3f }%s\n",
+                    r.name, r.size, static_cast<unsigned long long>(r.ops), r.ns_per_op,
+                    (i + 1 < results.size()) ? "," : "");
+        }
+        fprintf(out, "  ]\n}\n");
+    }
+
+}// namespace
+
+int main(int argc, char* argv[]) {
+    bench_options options;
+    for (int i = 1; i < argc; i++) {
+        if (std::strcmp(argv[i], "-o") == 0 && i + 1 < argc) {
+            options.output = argv[++i];
+        }
+        else if (std::strcmp(argv[i], "--min-time-ms") == 0 && i + 1 < argc) {
+            options.min_time = std::chrono::milliseconds{ std::atoi(argv[++i]) };
+        }
+        else if (std::strcmp(argv[i], "--filter") == 0 && i + 1 < argc) {
+            options.filter = argv[++i];
+        }
+        else {
+            fprintf(stderr, "usage: %s [-o FILE] [--min-time-ms N] [--filter TEXT]\n", argv[0]);
+            return 1;
+        }
+    }
+
+    std::vector<bench_result> all;
+    bench_sizes<4, 16, 64>(options, all);
+    bench_coro_create(options, all);
+    bench_suspend_resume(options, all);
+
+    // Groups are run together, drop the results that were not selected.
+    std::vector<bench_result> results;
+    for (const auto& r : all) {
+        if (selected(options, r.name)) {
+            results.push_back(r);
+        }
+    }
+
+    FILE* out = options.output ? fopen(options.output, "w") : stdout;
+    if (!out) {
+        fprintf(stderr, "%s: cannot write %s\n", argv[0], options.output);
+        return 1;
+    }
+    write_json(out, results);
+    if (out != stdout) {
+        fclose(out);
+    }
+    return 0;
+}
@@ -0,0 +1,244 @@
+/*
+   Cycle benchmarks of the co-routine runtime, run on the target or a simulator.
+
+   A fixed suite is run once, mcycle and minstret are read around each
+   benchmark with driver::pmu and the results are written to the
+   cycle_bench_log table. bench_done() is called when the table is
+   complete, run_cycle_benchmarks.py stops the simulator there and reads
+   the table. On the host the results are printed.
+
+   SPDX-License-Identifier: Unlicense
+
+   https://five-embeddev.com/
+
+*/
+
+#include <array>
+#include <coroutine>
+#include <cstdint>
+
+#if defined(HOST_EMULATION)
+#include <cstdio>
+#endif
+
+#include "embeddev_riscv.hpp"
+#include "embeddev_coro.hpp"
+
+/** Benchmark identifiers, the names are in run_cycle_benchmarks.py */
+enum class cycle_bench : std::uint32_t {
+    context_switch = 1,
+    timer_insert = 2,
+    isr_round_trip = 3,
+    channel_ping_pong = 4,
+};
+
+/** Result of one benchmark. */
+struct cycle_bench_result {
+    std::uint32_t id;
+    std::uint32_t iterations;
+    std::uint64_t cycles;
+    std::uint64_t instret;
+};
+
+static constexpr std::uint32_t CYCLE_BENCH_MAGIC = 0x31594342;// "BCY1"
+static constexpr std::size_t CYCLE_BENCH_ENTRIES = 8;
+
+/** Results table, read by the runner script. */
+struct alignas(8) cycle_bench_table {
+    std::uint32_t magic;
+    std::uint32_t count;
+    cycle_bench_result results[CYCLE_BENCH_ENTRIES];
+};
+
+extern "C" {
+/** Benchmark results, run_cycle_benchmarks.py reads them at the address of this symbol. */
+cycle_bench_table cycle_bench_log{};
+/** Called when cycle_bench_log is complete, the runner stops the simulator here. */
+void bench_done(void) __attribute__((noinline));
+}
+
+void bench_done(void) {
+    __asm__ volatile("" ::: "memory");
+}
+
+/** Operations per benchmark. */
+static constexpr std::uint32_t ITERATIONS = 100;
+static_assert(ITERATIONS % 2 == 0, "context_switch resumes in pairs");
+/** Entries in the timer scheduler for timer_insert. */
+static constexpr std::size_t TIMER_TASKS = 8;
+
+using bench_counters = driver::pmu<2>;
+
+static void record(cycle_bench id, std::uint32_t iterations, bench_counters& counters) {
+    auto& log = cycle_bench_log;
+    if (log.count < CYCLE_BENCH_ENTRIES) {
+        log.results[log.count++] = { static_cast<std::uint32_t>(id), iterations, counters.value(0), counters.value(1) };
+    }
+    counters.reset();
+}
+
+/** Alternate between two schedulers, scheduler_unordered::resume() runs until its list is empty. */
+static nop_task yield_task(scheduler_unordered<1>& a, scheduler_unordered<1>& b) {
+    while (true) {
+        co_await a;
+        co_await b;
+    }
+}
+
+/** Resumed from the ISR, counts the interrupts, then continues in main. */
+static nop_task isr_task(scheduler_unordered<1>& isr_context,
+                         scheduler_unordered<1>& main_context,
+                         volatile std::uint32_t& count) {
+    while (true) {
+        co_await isr_context;
+        count = count + 1;
+        co_await main_context;
+    }
+}
+
+/** Event bits of the ping-pong channel. */
+static constexpr event_mask_t PING = 1;
+static constexpr event_mask_t PONG = 2;
+
+/** Send PING and wait for PONG, iterations times. */
+static nop_task ping_task(event_group<2>& channel, std::uint32_t iterations) {
+    for (std::uint32_t i = 0; i < iterations; i++) {
+        channel.set(PING);
+        co_await channel.wait_any(PONG);
+    }
+}
+
+/** Answer each PING with PONG. */
+static nop_task pong_task(event_group<2>& channel) {
+    while (true) {
+        co_await channel.wait_any(PING);
+        channel.set(PONG);
+    }
+}
+
+/** Suspend and resume one co-routine via scheduler_unordered. */
+static void bench_context_switch(bench_counters& counters) {
+    scheduler_unordered<1> a;
+    scheduler_unordered<1> b;
+    auto t = yield_task(a, b);
+    (void)t;
+    counters.start();
+    for (std::uint32_t i = 0; i < ITERATIONS; i += 2) {
+        a.resume();
+        b.resume();
+    }
+    counters.stop();
+    record(cycle_bench::context_switch, ITERATIONS, counters);
+}
+
+/** Insert into a timer scheduler holding up to TIMER_TASKS entries, including reading mtime.
+    The scheduler is drained between batches, that is not counted.
+ */
+static void bench_timer_insert(bench_counters& counters) {
+    using SCHEDULER = scheduler_ordered<schedule_by_delay<mtimer_clock>, TIMER_TASKS>;
+    SCHEDULER scheduler;
+    const std::coroutine_handle<> handle = std::noop_coroutine();
+    const std::uint32_t batches = ITERATIONS / TIMER_TASKS;
+    for (std::uint32_t b = 0; b < batches; b++) {
+        counters.start();
+        for (std::size_t i = 0; i < TIMER_TASKS; i++) {
+            // Out of order delays, so entries are inserted along the list.
+            const auto delay = std::chrono::microseconds{ 100 * ((i * 5) % TIMER_TASKS) };
+            scheduler.insert(handle, SCHEDULER::make_condition(delay));
+        }
+        counters.stop();
+        // All entries are due before this condition.
+        const schedule_by_delay<mtimer_clock> drain{ 1s };
+        while (scheduler.resume(drain).first) {
+        }
+    }
+    record(cycle_bench::timer_insert, batches * TIMER_TASKS, counters);
+}
+
+/** Raise the software interrupt, wait until a co-routine is resumed in the ISR,
+    then resume it from main so it waits on the ISR again.
+ */
+static void bench_isr_round_trip(bench_counters& counters) {
+    driver::msip<> msip;
+    scheduler_unordered<1> isr_context;
+    scheduler_unordered<1> main_context;
+    static volatile std::uint32_t isr_count{ 0 };
+    auto t = isr_task(isr_context, main_context, isr_count);
+    (void)t;
+
+    static const auto handler = [&](void) {
+        auto this_cause = riscv::csrs.mcause.read();
+        if ((this_cause & riscv::csr::mcause_data::interrupt::BIT_MASK)
+            && ((this_cause & 0xFF) == riscv::interrupts::msi)) {
+            msip.clear();
+            isr_context.resume();
+        }
+    };
+    riscv::irq::handler irq_handler(handler);
+    riscv::csrs.mie.msi.set();
+    riscv::csrs.mstatus.mie.set();
+
+    counters.start();
+    for (std::uint32_t i = 0; i < ITERATIONS; i++) {
+        const std::uint32_t count = isr_count;
+        msip.set();
+        while (isr_count == count) {
+        }
+        main_context.resume();
+    }
+    counters.stop();
+
+    riscv::csrs.mstatus.mie.clr();
+    riscv::csrs.mie.msi.clr();
+    record(cycle_bench::isr_round_trip, ITERATIONS, counters);
+}
+
+/** Two co-routines exchange a message over an event group.
+ */
+static void bench_channel_ping_pong(bench_counters& counters) {
+    event_group<2> channel;
+    auto pong = pong_task(channel);
+    (void)pong;
+    // Sends the first PING and waits.
+    auto ping = ping_task(channel, ITERATIONS);
+    (void)ping;
+    counters.start();
+    channel.resume();
+    counters.stop();
+    record(cycle_bench::channel_ping_pong, ITERATIONS, counters);
+}
+
+int main(int argc, const char** argv) {
+#if defined(HOST_EMULATION)
+    driver::timer<> mtimer;
+    riscv_cpu_t core{ argc, argv, riscv::csrs, mtimer };
+    (void)core;
+#else
+    (void)argc;
+    (void)argv;
+#endif
+    riscv::csrs.mstatus.mie.clr();
+
+    bench_counters counters{ { driver::pmu_event::cycles, driver::pmu_event::instructions } };
+    cycle_bench_log.magic = CYCLE_BENCH_MAGIC;
+    cycle_bench_log.count = 0;
+
+    bench_context_switch(counters);
+    bench_timer_insert(counters);
+    bench_isr_round_trip(counters);
+    bench_channel_ping_pong(counters);
+
+    bench_done();
+
+#if defined(HOST_EMULATION)
+    // Cycles and instructions are 0 if perf events are not accessible.
+    static const char* const names[] = { "", "context_switch", "timer_insert", "isr_round_trip", "channel_ping_pong" };
+    printf("benchmark,iterations,cycles,instret\n");
+    for (std::uint32_t i = 0; i < cycle_bench_log.count; i++) {
+        const auto& r = cycle_bench_log.results[i];
+        printf("%s,%u,%llu,%llu\n", names[r.id], r.iterations,
+               static_cast<unsigned long long>(r.cycles), static_cast<unsigned long long>(r.instret));
+    }
+#endif
+    return 0;
+}
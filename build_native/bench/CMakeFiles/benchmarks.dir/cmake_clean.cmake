@@ -0,0 +1,11 @@
+file(REMOVE_RECURSE
+  "CMakeFiles/benchmarks.dir/benchmarks.cpp.o"
+  "CMakeFiles/benchmarks.dir/benchmarks.cpp.o.d"
+  "benchmarks"
+  "benchmarks.pdb"
+)
+
+# Per-language clean rules from dependency scanning.
+foreach(lang CXX)
+  include(CMakeFiles/benchmarks.dir/cmake_clean_${lang}.cmake OPTIONAL)
+endforeach()
@@ -0,0 +1,13 @@
+file(REMOVE_RECURSE
+  "CMakeFiles/cycle_benchmarks.elf.dir/__/src/startup.cpp.o"
+  "CMakeFiles/cycle_benchmarks.elf.dir/__/src/startup.cpp.o.d"
+  "CMakeFiles/cycle_benchmarks.elf.dir/cycle_benchmarks.cpp.o"
+  "CMakeFiles/cycle_benchmarks.elf.dir/cycle_benchmarks.cpp.o.d"
+  "cycle_benchmarks.elf"
+  "cycle_benchmarks.elf.pdb"
+)
+
+# Per-language clean rules from dependency scanning.
+foreach(lang CXX)
+  include(CMakeFiles/cycle_benchmarks.elf.dir/cmake_clean_${lang}.cmake OPTIONAL)
+endforeach()
@@ -0,0 +1,25 @@
+
+# Consider dependencies only in project.
+set(CMAKE_DEPENDS_IN_PROJECT_ONLY OFF)
+
+# The set of languages for which implicit dependencies are needed:
+set(CMAKE_DEPENDS_LANGUAGES
+  )
+
+# The set of dependency files which are needed:
+set(CMAKE_DEPENDS_DEPENDENCY_FILES
+  "/root/repo/src/example_irq.cpp" "src/CMakeFiles/main.elf.dir/example_irq.cpp.o" "gcc" "src/CMakeFiles/main.elf.dir/example_irq.cpp.o.d"
+  "/root/repo/src/example_levels.cpp" "src/CMakeFiles/main.elf.dir/example_levels.cpp.o" "gcc" "src/CMakeFiles/main.elf.dir/example_levels.cpp.o.d"
+  "/root/repo/src/example_simple.cpp" "src/CMakeFiles/main.elf.dir/example_simple.cpp.o" "gcc" "src/CMakeFiles/main.elf.dir/example_simple.cpp.o.d"
+  "/root/repo/src/example_smp.cpp" "src/CMakeFiles/main.elf.dir/example_smp.cpp.o" "gcc" "src/CMakeFiles/main.elf.dir/example_smp.cpp.o.d"
+  "/root/repo/src/example_timer.cpp" "src/CMakeFiles/main.elf.dir/example_timer.cpp.o" "gcc" "src/CMakeFiles/main.elf.dir/example_timer.cpp.o.d"
+  "/root/repo/src/main.cpp" "src/CMakeFiles/main.elf.dir/main.cpp.o" "gcc" "src/CMakeFiles/main.elf.dir/main.cpp.o.d"
+  "/root/repo/src/startup.cpp" "src/CMakeFiles/main.elf.dir/startup.cpp.o" "gcc" "src/CMakeFiles/main.elf.dir/startup.cpp.o.d"
+  )
+
+# Targets to which this target links.
+set(CMAKE_TARGET_LINKED_INFO_FILES
+  )
+
+# Fortran module output directory.
+set(CMAKE_Fortran_TARGET_MODULE_DIR "")
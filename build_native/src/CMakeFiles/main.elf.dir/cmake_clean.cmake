@@ -0,0 +1,23 @@
+file(REMOVE_RECURSE
+  "CMakeFiles/main.elf.dir/example_irq.cpp.o"
+  "CMakeFiles/main.elf.dir/example_irq.cpp.o.d"
+  "CMakeFiles/main.elf.dir/example_levels.cpp.o"
+  "CMakeFiles/main.elf.dir/example_levels.cpp.o.d"
+  "CMakeFiles/main.elf.dir/example_simple.cpp.o"
+  "CMakeFiles/main.elf.dir/example_simple.cpp.o.d"
+  "CMakeFiles/main.elf.dir/example_smp.cpp.o"
+  "CMakeFiles/main.elf.dir/example_smp.cpp.o.d"
+  "CMakeFiles/main.elf.dir/example_timer.cpp.o"
+  "CMakeFiles/main.elf.dir/example_timer.cpp.o.d"
+  "CMakeFiles/main.elf.dir/main.cpp.o"
+  "CMakeFiles/main.elf.dir/main.cpp.o.d"
+  "CMakeFiles/main.elf.dir/startup.cpp.o"
+  "CMakeFiles/main.elf.dir/startup.cpp.o.d"
+  "main.elf"
+  "main.elf.pdb"
+)
+
+# Per-language clean rules from dependency scanning.
+foreach(lang CXX)
+  include(CMakeFiles/main.elf.dir/cmake_clean_${lang}.cmake OPTIONAL)
+endforeach()
@@ -0,0 +1,38 @@
+
+# Consider dependencies only in project.
+set(CMAKE_DEPENDS_IN_PROJECT_ONLY OFF)
+
+# The set of languages for which implicit dependencies are needed:
+set(CMAKE_DEPENDS_LANGUAGES
+  )
+
+# The set of dependency files which are needed:
+set(CMAKE_DEPENDS_DEPENDENCY_FILES
+  "/root/repo/src/startup.cpp" "test/CMakeFiles/unit_tests.dir/__/src/startup.cpp.o" "gcc" "test/CMakeFiles/unit_tests.dir/__/src/startup.cpp.o.d"
+  "/root/repo/test/test_deadline_coro.cpp" "test/CMakeFiles/unit_tests.dir/test_deadline_coro.cpp.o" "gcc" "test/CMakeFiles/unit_tests.dir/test_deadline_coro.cpp.o.d"
+  "/root/repo/test/test_deferred_queue.cpp" "test/CMakeFiles/unit_tests.dir/test_deferred_queue.cpp.o" "gcc" "test/CMakeFiles/unit_tests.dir/test_deferred_queue.cpp.o.d"
+  "/root/repo/test/test_event_group.cpp" "test/CMakeFiles/unit_tests.dir/test_event_group.cpp.o" "gcc" "test/CMakeFiles/unit_tests.dir/test_event_group.cpp.o.d"
+  "/root/repo/test/test_execution_levels.cpp" "test/CMakeFiles/unit_tests.dir/test_execution_levels.cpp.o" "gcc" "test/CMakeFiles/unit_tests.dir/test_execution_levels.cpp.o.d"
+  "/root/repo/test/test_executor.cpp" "test/CMakeFiles/unit_tests.dir/test_executor.cpp.o" "gcc" "test/CMakeFiles/unit_tests.dir/test_executor.cpp.o.d"
+  "/root/repo/test/test_host_irq.cpp" "test/CMakeFiles/unit_tests.dir/test_host_irq.cpp.o" "gcc" "test/CMakeFiles/unit_tests.dir/test_host_irq.cpp.o.d"
+  "/root/repo/test/test_host_wfi.cpp" "test/CMakeFiles/unit_tests.dir/test_host_wfi.cpp.o" "gcc" "test/CMakeFiles/unit_tests.dir/test_host_wfi.cpp.o.d"
+  "/root/repo/test/test_jitter.cpp" "test/CMakeFiles/unit_tests.dir/test_jitter.cpp.o" "gcc" "test/CMakeFiles/unit_tests.dir/test_jitter.cpp.o.d"
+  "/root/repo/test/test_latency.cpp" "test/CMakeFiles/unit_tests.dir/test_latency.cpp.o" "gcc" "test/CMakeFiles/unit_tests.dir/test_latency.cpp.o.d"
+  "/root/repo/test/test_pc_sampler.cpp" "test/CMakeFiles/unit_tests.dir/test_pc_sampler.cpp.o" "gcc" "test/CMakeFiles/unit_tests.dir/test_pc_sampler.cpp.o.d"
+  "/root/repo/test/test_pmu.cpp" "test/CMakeFiles/unit_tests.dir/test_pmu.cpp.o" "gcc" "test/CMakeFiles/unit_tests.dir/test_pmu.cpp.o.d"
+  "/root/repo/test/test_priority_coro.cpp" "test/CMakeFiles/unit_tests.dir/test_priority_coro.cpp.o" "gcc" "test/CMakeFiles/unit_tests.dir/test_priority_coro.cpp.o.d"
+  "/root/repo/test/test_smp_executor.cpp" "test/CMakeFiles/unit_tests.dir/test_smp_executor.cpp.o" "gcc" "test/CMakeFiles/unit_tests.dir/test_smp_executor.cpp.o.d"
+  "/root/repo/test/test_static_list.cpp" "test/CMakeFiles/unit_tests.dir/test_static_list.cpp.o" "gcc" "test/CMakeFiles/unit_tests.dir/test_static_list.cpp.o.d"
+  "/root/repo/test/test_task_accounting.cpp" "test/CMakeFiles/unit_tests.dir/test_task_accounting.cpp.o" "gcc" "test/CMakeFiles/unit_tests.dir/test_task_accounting.cpp.o.d"
+  "/root/repo/test/test_timer_coro.cpp" "test/CMakeFiles/unit_tests.dir/test_timer_coro.cpp.o" "gcc" "test/CMakeFiles/unit_tests.dir/test_timer_coro.cpp.o.d"
+  "/root/repo/test/test_trace.cpp" "test/CMakeFiles/unit_tests.dir/test_trace.cpp.o" "gcc" "test/CMakeFiles/unit_tests.dir/test_trace.cpp.o.d"
+  "/root/repo/test/test_unordered.cpp" "test/CMakeFiles/unit_tests.dir/test_unordered.cpp.o" "gcc" "test/CMakeFiles/unit_tests.dir/test_unordered.cpp.o.d"
+  "/root/repo/test/unit_tests.cpp" "test/CMakeFiles/unit_tests.dir/unit_tests.cpp.o" "gcc" "test/CMakeFiles/unit_tests.dir/unit_tests.cpp.o.d"
+  )
+
+# Targets to which this target links.
+set(CMAKE_TARGET_LINKED_INFO_FILES
+  )
+
+# Fortran module output directory.
+set(CMAKE_Fortran_TARGET_MODULE_DIR "")
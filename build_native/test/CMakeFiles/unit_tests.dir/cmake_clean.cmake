@@ -0,0 +1,49 @@
+file(REMOVE_RECURSE
+  "CMakeFiles/unit_tests.dir/__/src/startup.cpp.o"
+  "CMakeFiles/unit_tests.dir/__/src/startup.cpp.o.d"
+  "CMakeFiles/unit_tests.dir/test_deadline_coro.cpp.o"
+  "CMakeFiles/unit_tests.dir/test_deadline_coro.cpp.o.d"
+  "CMakeFiles/unit_tests.dir/test_deferred_queue.cpp.o"
+  "CMakeFiles/unit_tests.dir/test_deferred_queue.cpp.o.d"
+  "CMakeFiles/unit_tests.dir/test_event_group.cpp.o"
+  "CMakeFiles/unit_tests.dir/test_event_group.cpp.o.d"
+  "CMakeFiles/unit_tests.dir/test_execution_levels.cpp.o"
+  "CMakeFiles/unit_tests.dir/test_execution_levels.cpp.o.d"
+  "CMakeFiles/unit_tests.dir/test_executor.cpp.o"
+  "CMakeFiles/unit_tests.dir/test_executor.cpp.o.d"
+  "CMakeFiles/unit_tests.dir/test_host_irq.cpp.o"
+  "CMakeFiles/unit_tests.dir/test_host_irq.cpp.o.d"
+  "CMakeFiles/unit_tests.dir/test_host_wfi.cpp.o"
+  "CMakeFiles/unit_tests.dir/test_host_wfi.cpp.o.d"
+  "CMakeFiles/unit_tests.dir/test_jitter.cpp.o"
+  "CMakeFiles/unit_tests.dir/test_jitter.cpp.o.d"
+  "CMakeFiles/unit_tests.dir/test_latency.cpp.o"
+  "CMakeFiles/unit_tests.dir/test_latency.cpp.o.d"
+  "CMakeFiles/unit_tests.dir/test_pc_sampler.cpp.o"
+  "CMakeFiles/unit_tests.dir/test_pc_sampler.cpp.o.d"
+  "CMakeFiles/unit_tests.dir/test_pmu.cpp.o"
+  "CMakeFiles/unit_tests.dir/test_pmu.cpp.o.d"
+  "CMakeFiles/unit_tests.dir/test_priority_coro.cpp.o"
+  "CMakeFiles/unit_tests.dir/test_priority_coro.cpp.o.d"
+  "CMakeFiles/unit_tests.dir/test_smp_executor.cpp.o"
+  "CMakeFiles/unit_tests.dir/test_smp_executor.cpp.o.d"
+  "CMakeFiles/unit_tests.dir/test_static_list.cpp.o"
+  "CMakeFiles/unit_tests.dir/test_static_list.cpp.o.d"
+  "CMakeFiles/unit_tests.dir/test_task_accounting.cpp.o"
+  "CMakeFiles/unit_tests.dir/test_task_accounting.cpp.o.d"
+  "CMakeFiles/unit_tests.dir/test_timer_coro.cpp.o"
+  "CMakeFiles/unit_tests.dir/test_timer_coro.cpp.o.d"
+  "CMakeFiles/unit_tests.dir/test_trace.cpp.o"
+  "CMakeFiles/unit_tests.dir/test_trace.cpp.o.d"
+  "CMakeFiles/unit_tests.dir/test_unordered.cpp.o"
+  "CMakeFiles/unit_tests.dir/test_unordered.cpp.o.d"
+  "CMakeFiles/unit_tests.dir/unit_tests.cpp.o"
+  "CMakeFiles/unit_tests.dir/unit_tests.cpp.o.d"
+  "unit_tests"
+  "unit_tests.pdb"
+)
+
+# Per-language clean rules from dependency scanning.
+foreach(lang CXX)
+  include(CMakeFiles/unit_tests.dir/cmake_clean_${lang}.cmake OPTIONAL)
+endforeach()
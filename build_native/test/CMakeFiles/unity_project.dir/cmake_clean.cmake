@@ -0,0 +1,16 @@
+file(REMOVE_RECURSE
+  "CMakeFiles/unity_project"
+  "CMakeFiles/unity_project-complete"
+  "unity_project/src/unity_project-stamp/unity_project-build"
+  "unity_project/src/unity_project-stamp/unity_project-configure"
+  "unity_project/src/unity_project-stamp/unity_project-download"
+  "unity_project/src/unity_project-stamp/unity_project-install"
+  "unity_project/src/unity_project-stamp/unity_project-mkdir"
+  "unity_project/src/unity_project-stamp/unity_project-patch"
+  "unity_project/src/unity_project-stamp/unity_project-update"
+)
+
+# Per-language clean rules from dependency scanning.
+foreach(lang )
+  include(CMakeFiles/unity_project.dir/cmake_clean_${lang}.cmake OPTIONAL)
+endforeach()
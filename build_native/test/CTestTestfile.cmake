@@ -0,0 +1,8 @@
+# CMake generated Testfile for 
+# Source directory: /root/repo/test
+# Build directory: /root/repo/build_native/test
+# 
+# This file includes the relevant testing commands required for 
+# testing this directory and lists subdirectories to be tested as well.
+add_test(unit_tests_run "/root/repo/build_native/test/unit_tests" "--output-on-failure")
+set_tests_properties(unit_tests_run PROPERTIES  _BACKTRACE_TRIPLES "/root/repo/test/CMakeLists.txt;32;add_test;/root/repo/test/CMakeLists.txt;0;")
@@ -0,0 +1,22 @@
+# Distributed under the OSI-approved BSD 3-Clause License.  See accompanying
+# file Copyright.txt or https://cmake.org/licensing for details.
+
+cmake_minimum_required(VERSION 3.5)
+
+file(MAKE_DIRECTORY
+  "/root/repo/build_native/test/unity_project/src/unity_project"
+  "/root/repo/build_native/test/unity_project/src/unity_project-build"
+  "/root/repo/build_native/test/unity_project"
+  "/root/repo/build_native/test/unity_project/tmp"
+  "/root/repo/build_native/test/unity_project/src/unity_project-stamp"
+  "/root/repo/build_native/test/unity_project/src"
+  "/root/repo/build_native/test/unity_project/src/unity_project-stamp"
+)
+
+set(configSubDirs )
+foreach(subDir IN LISTS configSubDirs)
+    file(MAKE_DIRECTORY "/root/repo/build_native/test/unity_project/src/unity_project-stamp/${subDir}")
+endforeach()
+if(cfgdir)
+  file(MAKE_DIRECTORY "/root/repo/build_native/test/unity_project/src/unity_project-stamp${cfgdir}") # cfgdir has leading slash
+endif()
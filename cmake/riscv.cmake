@@ -47,7 +47,25 @@ message( "RISC-V Cross Compile: ${CROSS_COMPILE}" )
 # The Generic system name is used for embedded targets (targets without OS) in
 # CMake
 set( CMAKE_SYSTEM_NAME          Generic )
-set( CMAKE_SYSTEM_PROCESSOR     rv32imac_zicsr )
+# The ISA can be selected with -DRISCV_ARCH=rv32gc etc, the ABI is derived from it.
+set( RISCV_ARCH rv32imac_zicsr CACHE STRING "Target RISC-V ISA, passed as -march" )
+set( CMAKE_SYSTEM_PROCESSOR     ${RISCV_ARCH} )
+if( RISCV_ARCH MATCHES "^rv64" )
+  set( RISCV_ABI_BASE lp64 )
+  # RAM at 0x80000000 (src/linker.lds) is outside the +/-2GiB of the default
+  # medlow model on RV64, absolute addressing truncates R_RISCV_HI20.
+  set( RISCV_CMODEL "-mcmodel=medany" )
+else()
+  set( RISCV_ABI_BASE ilp32 )
+  set( RISCV_CMODEL "" )
+endif()
+if( RISCV_ARCH MATCHES "^rv(32|64)(g|[a-z]*d)" )
+  set( RISCV_ABI ${RISCV_ABI_BASE}d )
+elseif( RISCV_ARCH MATCHES "^rv(32|64)[a-z]*f" )
+  set( RISCV_ABI ${RISCV_ABI_BASE}f )
+else()
+  set( RISCV_ABI ${RISCV_ABI_BASE} )
+endif()
 set( CMAKE_EXECUTABLE_SUFFIX    ".elf")
 
 # specify the cross compiler. We force the compiler so that CMake doesn't
@@ -74,9 +92,9 @@ set( CMAKE_OBJDUMP      ${RISCV_TOOLCHAIN_BIN_PATH}/${CROSS_COMPILE}objdump
 
 # Set the CMAKE C flags (which should also be used by the assembler!
 set( CMAKE_C_FLAGS "${CMAKE_C_FLAGS} -g" )
-set( CMAKE_C_FLAGS "${CMAKE_C_FLAGS} -march=${CMAKE_SYSTEM_PROCESSOR}" )
+set( CMAKE_C_FLAGS "${CMAKE_C_FLAGS} -march=${CMAKE_SYSTEM_PROCESSOR} -mabi=${RISCV_ABI} ${RISCV_CMODEL}" )
 
 set( CMAKE_C_FLAGS "${CMAKE_C_FLAGS}" CACHE STRING "-march=${CMAKE_SYSTEM_PROCESSOR} " )
 set( CMAKE_CXX_FLAGS "${CMAKE_C_FLAGS}" CACHE STRING "" )
 set( CMAKE_ASM_FLAGS "${CMAKE_C_FLAGS}" CACHE STRING "" )
-set( CMAKE_EXE_LINKER_FLAGS   "${CMAKE_EXE_LINKER_FLAGS}  -march=${CMAKE_SYSTEM_PROCESSOR}    -nostartfiles   " )
+set( CMAKE_EXE_LINKER_FLAGS   "${CMAKE_EXE_LINKER_FLAGS}  -march=${CMAKE_SYSTEM_PROCESSOR} -mabi=${RISCV_ABI} ${RISCV_CMODEL}    -nostartfiles   " )
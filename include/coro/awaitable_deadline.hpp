@@ -0,0 +1,83 @@
+/*
+   Create an awaitable concept for use with the earliest deadline first scheduler
+
+   SPDX-License-Identifier: Unlicense
+
+   https://five-embeddev.com/
+
+*/
+
+#ifndef AWAITABLE_DEADLINE_HPP
+#define AWAITABLE_DEADLINE_HPP
+
+#include "scheduler_deadline.hpp"
+
+#include <coroutine>
+#include <chrono>
+
+/* A class that implements the Awaitable concept.
+   The template paramter is a scheduler.
+
+   @tparam SCHEDULER The scheduler that will implement this deadline, e.g. scheduler_deadline.
+
+*/
+template<class SCHEDULER>
+struct awaitable_deadline {
+
+    /** Create a release delay and deadline that can implment `co_await.
+        @param scheduler  The object that will manage the execution of our co-routine.
+        @param release    The time until the co-routine is released.
+        @param deadline   The deadline relative to the release.
+        @param stats      Optional deadline statistics of the co-routine.
+    */
+    awaitable_deadline(SCHEDULER& scheduler,
+                       std::chrono::microseconds release,
+                       std::chrono::microseconds deadline,
+                       deadline_stats* stats)
+        : scheduler_{ scheduler }
+        , release_{ release }
+        , deadline_{ deadline }
+        , stats_{ stats } {}
+
+    bool await_ready() {
+        // Always suspend, a released co-routine still waits for earlier deadlines.
+        return false;
+    }
+    void await_suspend(std::coroutine_handle<> handle) {
+        // Insert into the schedule.
+        scheduler_.insert(handle, typename SCHEDULER::CONDITION{ release_, deadline_, stats_ });
+    }
+    void await_resume() {
+        LATENCY_RESUME();
+        // NOTE - At this point the member may have been clobered - dont' trust _release..
+    }
+
+  private:
+    SCHEDULER& scheduler_;
+    const std::chrono::microseconds release_; // Relative release
+    const std::chrono::microseconds deadline_;// Relative to release
+    deadline_stats* const stats_;
+};
+
+
+/** Convinence structure to group a co-routine scheduler, release delay and deadline.
+ */
+template<typename SCHEDULER>
+struct scheduled_deadline {
+    SCHEDULER& scheduler;
+    std::chrono::microseconds release;
+    std::chrono::microseconds deadline;
+    deadline_stats* stats{ nullptr };
+};
+
+/** Allow a scheduler, release delay and deadline to be directly 'awaited' on.
+ */
+template<typename SCHEDULER>
+auto operator co_await(scheduled_deadline<SCHEDULER>&& schedule_deadline) {
+    return awaitable_deadline<SCHEDULER>{ schedule_deadline.scheduler,
+                                          schedule_deadline.release,
+                                          schedule_deadline.deadline,
+                                          schedule_deadline.stats };
+}
+
+#endif// AWAITABLE_DEADLINE_HPP
@@ -0,0 +1,218 @@
+/*
+   Event flag group that co-routines can wait on.
+
+   Event bits are set atomically from ISRs or co-routines, a
+   co-routine can wait for any or all bits of a mask to be set.
+
+   SPDX-License-Identifier: Unlicense
+
+   https://five-embeddev.com/
+
+*/
+
+#ifndef AWAITABLE_EVENT_GROUP_HPP
+#define AWAITABLE_EVENT_GROUP_HPP
+
+#include <coroutine>
+#include <atomic>
+#include <cstdint>
+
+#include "static_list.hpp"
+#include "../debug/latency.hpp"
+#include "../debug/trace.hpp"
+#include "../debug/task_accounting.hpp"
+
+/** Bit mask of events, one bit per event source. */
+using event_mask_t = std::uint32_t;
+
+template<std::size_t MAX_TASKS>
+struct awaitable_event_group;
+
+/* A group of event flags and the co-routines waiting on them.
+
+   Flags can be set from any context, the update is atomic.
+
+   Waiting co-routines are resumed by calling resume(), this should
+   be called from a single context (e.g. the main loop after WFI) as
+   the list of waiting co-routines is not protected.
+
+   Event bits that wake a co-routine are consumed (cleared) when it is woken.
+
+   @tparam MAX_TASKS          A fixed array is used to hold waiting co-routines. This is the maximum number of entries.
+
+ */
+template<std::size_t MAX_TASKS = 10>
+class event_group {
+
+  public:
+    // Defaults
+    event_group() {}
+
+    // The event_group is intended to be instanciated once.
+    event_group(const event_group&) = delete;
+    event_group(event_group&&) = delete;
+    event_group& operator=(const event_group&) = delete;
+    event_group& operator=(event_group&&) = delete;
+
+    /** Set event bits. Safe to call from an ISR.
+        @param mask Bits to set.
+     */
+    void set(event_mask_t mask) noexcept {
+        flags_.fetch_or(mask);
+    }
+
+    /** Clear event bits. Safe to call from an ISR.
+        @param mask Bits to clear.
+     */
+    void clear(event_mask_t mask) noexcept {
+        flags_.fetch_and(~mask);
+    }
+
+    /** Current event bits that have not been consumed by a waiting co-routine.
+     */
+    event_mask_t flags() const noexcept {
+        return flags_.load();
+    }
+
+    /** Test for an empty wait list.
+        @retval true There are no co-routines waiting on events.
+     */
+    bool empty() const noexcept {
+        return waiting_.empty();
+    }
+
+    /** Awaitable to wait until any bit in mask is set.
+        The co_await expression returns the bits that were set.
+     */
+    awaitable_event_group<MAX_TASKS> wait_any(event_mask_t mask) noexcept {
+        return { *this, mask, false };
+    }
+
+    /** Awaitable to wait until all bits in mask are set.
+        The co_await expression returns the bits that were set.
+     */
+    awaitable_event_group<MAX_TASKS> wait_all(event_mask_t mask) noexcept {
+        return { *this, mask, true };
+    }
+
+    /* Wakeup the co-routines whose wait condition is met.
+
+       The list is visited from the start after each co-routine is
+       resumed, as the resumed co-routine may wait again.
+     */
+    void resume(void) {
+        auto i = waiting_.begin();
+        while (i != waiting_.end()) {
+            if (take(i->mask, i->wait_all, *i->result)) {
+                auto handle{ i->handle };
+                waiting_.erase(i);
+                TRACE_EVENT(scheduler_wake, this);
+                LATENCY_DISPATCH();
+                TRACE_EVENT(coro_resume, handle.address());
+                TASK_ACCOUNT_RESUME();
+                handle.resume();
+                TASK_ACCOUNT_SUSPEND(handle);
+                TRACE_EVENT(coro_suspend, handle.address());
+                i = waiting_.begin();
+            }
+            else {
+                ++i;
+            }
+        }
+    }
+
+  private:
+    /** A co-routine waiting on a set of events. */
+    struct wait_entry {
+        wait_entry(std::coroutine_handle<> handle,
+                   event_mask_t mask,
+                   bool wait_all,
+                   event_mask_t* result)
+            : handle{ handle }
+            , mask{ mask }
+            , wait_all{ wait_all }
+            , result{ result } {}
+        std::coroutine_handle<> handle;
+        event_mask_t mask;
+        bool wait_all;
+        event_mask_t* result;// Location to write the consumed event bits.
+    };
+
+    /** Atomically test and consume the bits for a wait condition.
+        @param mask      Bits being waited on.
+        @param wait_all  Require all bits in mask, otherwise any bit.
+        @param result    Set to the bits that were consumed.
+        @retval true  The condition was met and the bits were consumed.
+     */
+    bool take(event_mask_t mask, bool wait_all, event_mask_t& result) noexcept {
+        event_mask_t current = flags_.load();
+        event_mask_t hit;
+        do {
+            hit = current & mask;
+            if (wait_all ? (hit != mask) : (hit == 0)) {
+                return false;
+            }
+        } while (!flags_.compare_exchange_weak(current, current & ~hit));
+        result = hit;
+        return true;
+    }
+
+    void insert(std::coroutine_handle<> handle,
+                event_mask_t mask,
+                bool wait_all,
+                event_mask_t* result) {
+        TRACE_EVENT(scheduler_insert, handle.address());
+        waiting_.emplace_back(handle, mask, wait_all, result);
+    }
+
+    friend struct awaitable_event_group<MAX_TASKS>;
+
+    //! Event bits set and not yet consumed.
+    std::atomic<event_mask_t> flags_{ 0 };
+    //! Set of waiting tasks
+    static_list<wait_entry, MAX_TASKS> waiting_;
+};
+
+/* A class that implements the Awaitable concept for an event_group.
+
+   @tparam MAX_TASKS The size of the event_group.
+
+*/
+template<std::size_t MAX_TASKS>
+struct awaitable_event_group {
+
+    using EVENT_GROUP = event_group<MAX_TASKS>;
+
+    /** Create an awaitable for a set of events.
+        @param group     The event group that will resume this co-routine.
+        @param mask      The events to wait on.
+        @param wait_all  Wait for all events in mask, otherwise any event.
+    */
+    awaitable_event_group(EVENT_GROUP& group,
+                          event_mask_t mask,
+                          bool wait_all)
+        : group_{ group }
+        , mask_{ mask }
+        , wait_all_{ wait_all } {}
+
+    bool await_ready() noexcept(true) {
+        // Don't suspend if the events are already set.
+        return group_.take(mask_, wait_all_, result_);
+    }
+    void await_suspend(std::coroutine_handle<> handle) noexcept(true) {
+        // Wait in the group, the result is written on wakeup.
+        group_.insert(handle, mask_, wait_all_, &result_);
+    }
+    event_mask_t await_resume() noexcept(true) {
+        LATENCY_RESUME();
+        return result_;
+    }
+
+  private:
+    EVENT_GROUP& group_;
+    const event_mask_t mask_;
+    const bool wait_all_;
+    event_mask_t result_{ 0 };
+};
+
+#endif// AWAITABLE_EVENT_GROUP_HPP
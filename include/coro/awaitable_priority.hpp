@@ -42,6 +42,7 @@ struct awaitable_priority {
         scheduler_.insert(handle, schedule_by_priority{ priority_ });// TODO - implicit
     }
     void await_resume() {
+        LATENCY_RESUME();
         // NOTE - At this point the member may have been clobered - dont' trust _delay..
     }
 
@@ -14,6 +14,8 @@
 
 #include <coroutine>
 #include <chrono>
+#include <cstddef>
+#include <type_traits>
 
 /* A class that implements the Awaitable concept.
    The template paramter is a scheduler.
@@ -24,6 +26,11 @@
 template<class SCHEDULER>
 struct awaitable_timer {
 
+    /** The scheduler can create a wake condition with a deadline monitor. */
+    static constexpr bool monitored = requires(std::chrono::microseconds delay, deadline_monitor* monitor) {
+        SCHEDULER::make_condition(delay, monitor);
+    };
+
     /** Create a timer with a given delay that can implment `co_await.
         @param scheduler  The object that will manage the execution of our co-routine.
         @param  delay     The time that the co-routine will be delayed for.
@@ -33,37 +40,66 @@ struct awaitable_timer {
         : scheduler_{ scheduler }
         , delay_{ delay } {}
 
+    /** Create a timer with a given delay and deadline monitor that can implment `co_await.
+        @param scheduler  The object that will manage the execution of our co-routine.
+        @param  delay     The time that the co-routine will be delayed for.
+        @param  monitor   Deadline monitor of the co-routine, or nullptr.
+    */
+    awaitable_timer(SCHEDULER& scheduler,
+                    std::chrono::microseconds delay,
+                    deadline_monitor* monitor)
+        : scheduler_{ scheduler }
+        , delay_{ delay }
+        , monitor_{ monitor } {
+        static_assert(monitored, "The scheduler can't create a wake condition with a deadline monitor");
+    }
+
     bool await_ready() {
         // Returning true will execute immediately - Only wait if there is a delay.
         return delay_.count() == 0;
     }
     void await_suspend(std::coroutine_handle<> handle) {
         // Insert into the schedule.
+        if constexpr (monitored) {
+            if (monitor_) {
+                scheduler_.insert(handle, SCHEDULER::make_condition(delay_, monitor_));
+                return;
+            }
+        }
         scheduler_.insert(handle, SCHEDULER::make_condition(delay_));
     }
     void await_resume() {
+        LATENCY_RESUME();
         // NOTE - At this point the member may have been clobered - dont' trust _delay..
     }
 
   private:
     SCHEDULER& scheduler_;
     const std::chrono::microseconds delay_;// Relative delay
+    deadline_monitor* const monitor_{ nullptr };
 };
 
 
 /** Convinence structure to group a co-routine scheduler and delay.
+    MONITOR is deadline_monitor* when a deadline monitor is given, so it is known at compile time.
  */
-template<typename SCHEDULER, typename DELAY = std::chrono::microseconds>
+template<typename SCHEDULER, typename DELAY = std::chrono::microseconds, typename MONITOR = std::nullptr_t>
 struct scheduled_delay {
     SCHEDULER& scheduler;
     DELAY delay;
+    MONITOR monitor{};// Optional deadline monitor.
 };
 
 /** Allow a scheduler and  microseconds delay to be directly 'awaited' on.
  */
-template<typename SCHEDULER, typename DELAY = std::chrono::microseconds>
-auto operator co_await(scheduled_delay<SCHEDULER, DELAY>&& schedule_delay) {
-    return awaitable_timer<SCHEDULER>{ schedule_delay.scheduler, schedule_delay.delay };
+template<typename SCHEDULER, typename DELAY = std::chrono::microseconds, typename MONITOR = std::nullptr_t>
+auto operator co_await(scheduled_delay<SCHEDULER, DELAY, MONITOR>&& schedule_delay) {
+    if constexpr (std::is_null_pointer_v<MONITOR>) {
+        return awaitable_timer<SCHEDULER>{ schedule_delay.scheduler, schedule_delay.delay };
+    }
+    else {
+        return awaitable_timer<SCHEDULER>{ schedule_delay.scheduler, schedule_delay.delay, schedule_delay.monitor };
+    }
 }
 
 #endif// AWAITABLE_TIMER_HPP
@@ -43,6 +43,7 @@ struct awaitable_unordered {
         scheduler_.insert(handle);// TODO - implicit
     }
     void await_resume() noexcept(true) {
+        LATENCY_RESUME();
         // NOTE - At this point the member may have been clobered - dont' trust _delay..
     }
 
@@ -0,0 +1,74 @@
+/*
+   Deadline monitoring of timed waits.
+
+   A task attaches a deadline_monitor to its timed waits. When the
+   scheduler resumes the task later than the deadline plus the tolerance
+   the miss is counted and the overrun handler is called, so the
+   application can shed load.
+
+   SPDX-License-Identifier: Unlicense
+
+   https://five-embeddev.com/
+
+*/
+
+
+#ifndef DEADLINE_MONITOR_HPP
+#define DEADLINE_MONITOR_HPP
+
+#include <chrono>
+#include <cstdint>
+
+/** Deadline statistics of one task, owned by the task and updated by the scheduler.
+ */
+struct deadline_stats {
+    std::uint32_t released{ 0 };                 // Times the task was run by the scheduler.
+    std::uint32_t missed{ 0 };                   // Times the task was run after its deadline.
+    std::chrono::microseconds max_lateness{ 0 }; // Worst time between deadline and run.
+};
+
+/** Deadline, tolerance, statistics and overrun handler of one task.
+
+    Owned by the task and passed to each timed wait, e.g.
+
+        co_await scheduled_delay{ scheduler, period, &monitor };
+ */
+struct deadline_monitor {
+    /** Called from the scheduler, before the late task is resumed.
+        @param monitor   The monitor of the late task.
+        @param lateness  Time between the deadline and the resume.
+     */
+    using overrun_handler = void (*)(deadline_monitor& monitor, std::chrono::microseconds lateness);
+
+    //! Deadline relative to the scheduled wakeup.
+    std::chrono::microseconds deadline{ 0 };
+    //! Lateness after the deadline that is not a miss.
+    std::chrono::microseconds tolerance{ 0 };
+    //! Optional overrun handler.
+    overrun_handler overrun{ nullptr };
+    //! Application context for the overrun handler.
+    void* context{ nullptr };
+    deadline_stats stats{};
+
+    /** Called from the scheduler when the task is resumed.
+        @param late Time between the scheduled wakeup and the resume.
+     */
+    void woken(std::chrono::microseconds late) {
+        stats.released++;
+        if (late <= deadline) {
+            return;
+        }
+        const auto lateness = late - deadline;
+        if (lateness > stats.max_lateness) {
+            stats.max_lateness = lateness;
+        }
+        if (lateness > tolerance) {
+            stats.missed++;
+            if (overrun) {
+                overrun(*this, lateness);
+            }
+        }
+    }
+};
+
+#endif// DEADLINE_MONITOR_HPP
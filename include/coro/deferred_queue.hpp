@@ -0,0 +1,157 @@
+/*
+   Deferred work queue to move co-routine resumption out of ISRs.
+
+   An ISR posts a co-routine handle or a small callable to the queue
+   in O(1), the main loop drains the queue before going idle.
+
+   SPDX-License-Identifier: Unlicense
+
+   https://five-embeddev.com/
+
+*/
+
+#ifndef DEFERRED_QUEUE_HPP
+#define DEFERRED_QUEUE_HPP
+
+#include <coroutine>
+#include <atomic>
+#include <array>
+#include <cstdint>
+
+#include "../debug/trace.hpp"
+#include "../debug/task_accounting.hpp"
+
+/** A unit of deferred work. A function and context pointer, so it can be copied in an ISR.
+ */
+struct deferred_work {
+    void (*function)(void*);
+    void* context;
+
+    void operator()() const {
+        function(context);
+    }
+};
+
+/* Lock free single producer, single consumer queue of deferred work.
+
+   The producer is the ISR context and the consumer is the main loop,
+   so nested interrupts must not post to the same queue.
+
+   @tparam MAX_WORK   Maximum number of queued work items, must be a power of 2.
+
+ */
+template<std::size_t MAX_WORK = 8>
+class deferred_queue {
+    static_assert((MAX_WORK & (MAX_WORK - 1)) == 0, "MAX_WORK must be a power of 2");
+    static constexpr std::uint32_t INDEX_MASK = MAX_WORK - 1;
+
+  public:
+    // Defaults
+    deferred_queue() {}
+
+    // The deferred_queue is intended to be instanciated once.
+    deferred_queue(const deferred_queue&) = delete;
+    deferred_queue(deferred_queue&&) = delete;
+    deferred_queue& operator=(const deferred_queue&) = delete;
+    deferred_queue& operator=(deferred_queue&&) = delete;
+
+    /** Post work to be run by drain().
+        @retval true   The work was queued.
+        @retval false  The queue was full, the work was dropped.
+     */
+    bool post(deferred_work work) noexcept {
+        auto head = head_.load(std::memory_order_relaxed);
+        if (head - tail_.load(std::memory_order_acquire) == MAX_WORK) {
+            dropped_.store(dropped_.load(std::memory_order_relaxed) + 1, std::memory_order_relaxed);
+            return false;
+        }
+        work_[head & INDEX_MASK] = work;
+        head_.store(head + 1, std::memory_order_release);
+        return true;
+    }
+
+    /** Post a co-routine to be resumed by drain().
+     */
+    bool post(std::coroutine_handle<> handle) noexcept {
+        TRACE_EVENT(scheduler_insert, handle.address());
+        return post(deferred_work{ [](void* context) {
+                                      const auto handle = std::coroutine_handle<>::from_address(context);
+                                      TRACE_EVENT(coro_resume, context);
+                                      TASK_ACCOUNT_RESUME();
+                                      handle.resume();
+                                      TASK_ACCOUNT_SUSPEND(handle);
+                                      TRACE_EVENT(coro_suspend, context);
+                                  },
+                                   handle.address() });
+    }
+
+    /** Post a scheduler to be resumed by drain(), i.e. call scheduler.resume().
+     */
+    template<class SCHEDULER>
+    bool post_resume(SCHEDULER& scheduler) noexcept {
+        return post(deferred_work{ [](void* context) {
+                                      static_cast<SCHEDULER*>(context)->resume();
+                                  },
+                                   &scheduler });
+    }
+
+    /** Run all queued work, including work posted while draining.
+        @retval true Work was run.
+     */
+    bool drain() {
+        bool ran{ false };
+        auto tail = tail_.load(std::memory_order_relaxed);
+        while (tail != head_.load(std::memory_order_acquire)) {
+            auto work = work_[tail & INDEX_MASK];
+            tail_.store(++tail, std::memory_order_release);
+            work();
+            ran = true;
+        }
+        return ran;
+    }
+
+    /** Test for an empty queue.
+        Call with interrupts disabled before WFI to avoid missing work posted after drain().
+     */
+    bool empty() const noexcept {
+        return head_.load(std::memory_order_acquire) == tail_.load(std::memory_order_relaxed);
+    }
+
+    /** Number of work items dropped as the queue was full.
+     */
+    std::uint32_t dropped() const noexcept {
+        return dropped_.load(std::memory_order_relaxed);
+    }
+
+  private:
+    std::array<deferred_work, MAX_WORK> work_;
+    //! Write index, only modified by the producer.
+    std::atomic<std::uint32_t> head_{ 0 };
+    //! Read index, only modified by the consumer.
+    std::atomic<std::uint32_t> tail_{ 0 };
+    std::atomic<std::uint32_t> dropped_{ 0 };
+};
+
+/** Where co-routines waiting on an interrupt source are resumed.
+ */
+enum class isr_resume {
+    immediate,// Resume in the ISR. Lowest latency, longest ISR.
+    deferred  // Post to a deferred_queue and resume in the main loop. Shortest ISR.
+};
+
+/** Resume a scheduler from an ISR, the policy is selected at compile time per interrupt source.
+    @tparam MODE      isr_resume::immediate or isr_resume::deferred
+    @param scheduler  Scheduler of co-routines waiting on the interrupt source.
+    @param queue      Queue used for deferred resumption.
+ */
+template<isr_resume MODE, class SCHEDULER, std::size_t MAX_WORK>
+void resume_from_isr(SCHEDULER& scheduler, deferred_queue<MAX_WORK>& queue) {
+    if constexpr (MODE == isr_resume::immediate) {
+        scheduler.resume();
+    }
+    else {
+        queue.post_resume(scheduler);
+    }
+}
+
+#endif// DEFERRED_QUEUE_HPP
@@ -0,0 +1,286 @@
+/*
+   Preemptive execution levels for co-routines.
+
+   Each level has a list of co-routines. Level 0 is the thread level
+   and is run from the main loop, the higher levels are run from a
+   software interrupt. A co-routine at a higher level preempts the
+   co-routines at lower levels. All levels share a single stack.
+
+   Priority inversion is bounded by a level ceiling lock (stack
+   resource policy): while the lock is held only levels above the
+   ceiling may preempt.
+
+   SPDX-License-Identifier: Unlicense
+
+   https://five-embeddev.com/
+
+*/
+
+#ifndef EXECUTION_LEVELS_HPP
+#define EXECUTION_LEVELS_HPP
+
+#include <coroutine>
+#include <atomic>
+#include <array>
+#include <bit>
+#include <cstdint>
+
+#include "static_list.hpp"
+#include "../debug/latency.hpp"
+#include "../debug/trace.hpp"
+#include "../debug/task_accounting.hpp"
+
+/** Execution level, 0 is the thread level. */
+using execution_level_t = std::uint32_t;
+
+template<class EXECUTION_LEVELS>
+struct awaitable_execution_level;
+
+template<class EXECUTION_LEVELS>
+class execution_level_lock;
+
+/* A set of co-routine lists, each run at a fixed execution level.
+
+   The software interrupt is abstracted by LEVEL_IRQ:
+
+     LEVEL_IRQ::pend()     Request the software interrupt.
+     LEVEL_IRQ::clear()    Clear the software interrupt request.
+     LEVEL_IRQ::nested     Scope that enables nested interrupts in the handler.
+     LEVEL_IRQ::critical   Scope that disables interrupts.
+
+   dispatch() must be called from the software interrupt handler and
+   resume() from the main loop.
+
+   @tparam LEVEL_IRQ   Software interrupt used to run the levels above the thread level.
+   @tparam LEVELS      Number of levels, including the thread level.
+   @tparam MAX_TASKS   Maximum number of co-routines waiting at each level.
+
+ */
+template<class LEVEL_IRQ, std::size_t LEVELS = 3, std::size_t MAX_TASKS = 4>
+class execution_levels {
+    static_assert(LEVELS > 1 && LEVELS <= 32, "LEVELS must be in the range 2..32");
+
+  public:
+    static constexpr execution_level_t THREAD_LEVEL = 0;
+    static constexpr execution_level_t MAX_LEVEL = LEVELS - 1;
+
+    // Defaults
+    execution_levels() {}
+
+    // The execution_levels is intended to be instanciated once.
+    execution_levels(const execution_levels&) = delete;
+    execution_levels(execution_levels&&) = delete;
+    execution_levels& operator=(const execution_levels&) = delete;
+    execution_levels& operator=(execution_levels&&) = delete;
+
+    /** Awaitable to continue the co-routine at a given level.
+        The co-routine is run immediately if it is already at that level.
+     */
+    awaitable_execution_level<execution_levels> run_at(execution_level_t level) noexcept {
+        return { *this, level, true };
+    }
+
+    /** Awaitable to wait at a given level until the level is pended.
+     */
+    awaitable_execution_level<execution_levels> wait(execution_level_t level) noexcept {
+        return { *this, level, false };
+    }
+
+    /** Lock out preemption by all levels up to and including ceiling.
+        The lock is released when the returned object goes out of scope.
+     */
+    execution_level_lock<execution_levels> lock(execution_level_t ceiling) noexcept {
+        return { *this, ceiling };
+    }
+
+    /** Request the co-routines at a level to run. Safe to call from an ISR.
+        The software interrupt is only raised when the level can preempt the current level.
+     */
+    void pend(execution_level_t level) noexcept {
+        pending_.fetch_or(execution_level_t{ 1 } << level);
+        if (level > running_level_.load()) {
+            LEVEL_IRQ::pend();
+        }
+    }
+
+    /** The level of the code currently running.
+     */
+    execution_level_t running_level() const noexcept {
+        return running_level_.load();
+    }
+
+    /** Test for an empty level.
+        @retval true There are no co-routines waiting at the level.
+     */
+    bool empty(execution_level_t level = THREAD_LEVEL) const noexcept {
+        [[maybe_unused]] typename LEVEL_IRQ::critical critical;
+        return waiting_[level].empty();
+    }
+
+    /** Run the co-routines at the thread level. Called from the main loop.
+     */
+    void resume(void) {
+        pending_.fetch_and(~execution_level_t{ 1 });
+        run(THREAD_LEVEL);
+    }
+
+    /* Run the pended levels above the interrupted level, highest level first.
+       Called from the software interrupt handler with interrupts disabled.
+       Interrupts are enabled while the co-routines run, so a higher level can
+       preempt by nesting this call.
+     */
+    void dispatch(void) {
+        LEVEL_IRQ::clear();
+        const execution_level_t base = running_level_.load();
+        execution_level_t level;
+        while ((level = highest_pending()) > base) {
+            pending_.fetch_and(~(execution_level_t{ 1 } << level));
+            running_level_.store(level);
+            {
+                [[maybe_unused]] typename LEVEL_IRQ::nested nested;
+                run(level);
+            }
+            running_level_.store(base);
+        }
+    }
+
+  private:
+    friend struct awaitable_execution_level<execution_levels>;
+    friend class execution_level_lock<execution_levels>;
+
+    /** Add a co-routine to a level, optionally pending the level.
+        Nothing may refer to the awaitable after this call, as the co-routine may have
+        been resumed by a preempting level.
+     */
+    void insert(std::coroutine_handle<> handle, execution_level_t level, bool pend_level) {
+        {
+            [[maybe_unused]] typename LEVEL_IRQ::critical critical;
+            TRACE_EVENT(scheduler_insert, handle.address());
+            waiting_[level].emplace_back(handle);
+        }
+        if (pend_level) {
+            pend(level);
+        }
+    }
+
+    /** Restore the running level when a lock is released, and raise the
+        software interrupt for any level that was pended while locked.
+     */
+    void unlock(execution_level_t previous) noexcept {
+        running_level_.store(previous);
+        if (highest_pending() > previous) {
+            LEVEL_IRQ::pend();
+        }
+    }
+
+    /** Run the co-routines waiting at a level when it was started.
+        Co-routines that wait at the same level again are run on the next pend.
+     */
+    void run(execution_level_t level) {
+        auto& waiting = waiting_[level];
+        unsigned int count{ 0 };
+        {
+            [[maybe_unused]] typename LEVEL_IRQ::critical critical;
+            for (auto i = waiting.begin(); i != waiting.end(); ++i) {
+                count++;
+            }
+        }
+        while (count--) {
+            std::coroutine_handle<> handle;
+            {
+                [[maybe_unused]] typename LEVEL_IRQ::critical critical;
+                handle = waiting.front();
+                waiting.pop_front();
+            }
+            TRACE_EVENT(scheduler_wake, this);
+            LATENCY_DISPATCH();
+            TRACE_EVENT(coro_resume, handle.address());
+            TASK_ACCOUNT_RESUME();
+            handle.resume();
+            TASK_ACCOUNT_SUSPEND(handle);
+            TRACE_EVENT(coro_suspend, handle.address());
+        }
+    }
+
+    execution_level_t highest_pending() const noexcept {
+        auto pending = pending_.load();
+        return pending ? static_cast<execution_level_t>(std::bit_width(pending) - 1) : THREAD_LEVEL;
+    }
+
+    //! Bit per level that has been pended and not yet run.
+    std::atomic<execution_level_t> pending_{ 0 };
+    //! Level of the currently running code, or the ceiling of a held lock.
+    std::atomic<execution_level_t> running_level_{ THREAD_LEVEL };
+    //! Co-routines waiting at each level.
+    std::array<static_list<std::coroutine_handle<>, MAX_TASKS>, LEVELS> waiting_;
+};
+
+/* A class that implements the Awaitable concept for an execution level.
+
+   @tparam EXECUTION_LEVELS The execution_levels that will resume the co-routine.
+
+*/
+template<class EXECUTION_LEVELS>
+struct awaitable_execution_level {
+
+    /** Create an awaitable to move a co-routine to a level.
+        @param levels      The execution levels.
+        @param level       The level to run the co-routine at.
+        @param pend_level  Pend the level, otherwise wait until it is pended.
+    */
+    awaitable_execution_level(EXECUTION_LEVELS& levels,
+                              execution_level_t level,
+                              bool pend_level)
+        : levels_{ levels }
+        , level_{ level }
+        , pend_level_{ pend_level } {}
+
+    bool await_ready() noexcept(true) {
+        // Already at this level, no need to switch.
+        return pend_level_ && (levels_.running_level() == level_);
+    }
+    void await_suspend(std::coroutine_handle<> handle) noexcept(true) {
+        levels_.insert(handle, level_, pend_level_);
+    }
+    void await_resume() noexcept(true) {
+        LATENCY_RESUME();
+    }
+
+  private:
+    EXECUTION_LEVELS& levels_;
+    const execution_level_t level_;
+    const bool pend_level_;
+};
+
+/* Level ceiling lock. Raises the running level to the ceiling for the
+   lifetime of the object, so resources shared with levels up to the
+   ceiling can be accessed without disabling interrupts.
+
+   @tparam EXECUTION_LEVELS The execution_levels to lock.
+*/
+template<class EXECUTION_LEVELS>
+class execution_level_lock {
+  public:
+    execution_level_lock(EXECUTION_LEVELS& levels, execution_level_t ceiling) noexcept
+        : levels_{ levels }
+        , previous_{ levels.running_level() } {
+        if (ceiling > previous_) {
+            levels_.running_level_.store(ceiling);
+        }
+    }
+    ~execution_level_lock() {
+        levels_.unlock(previous_);
+    }
+
+    // Boilerplate delete defaults - non copyable class
+    execution_level_lock(const execution_level_lock&) = delete;
+    execution_level_lock& operator=(const execution_level_lock&) = delete;
+    execution_level_lock(execution_level_lock&&) = delete;
+    execution_level_lock& operator=(execution_level_lock&&) = delete;
+
+  private:
+    EXECUTION_LEVELS& levels_;
+    const execution_level_t previous_;
+};
+
+#endif// EXECUTION_LEVELS_HPP
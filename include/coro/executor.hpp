@@ -0,0 +1,152 @@
+/*
+   Executor to run the main loop of an application, composing the
+   delay, priority, unordered and ISR schedulers.
+
+   SPDX-License-Identifier: Unlicense
+
+   https://five-embeddev.com/
+
+*/
+
+#ifndef EXECUTOR_HPP
+#define EXECUTOR_HPP
+
+#include <coroutine>
+#include <chrono>
+#include <limits>
+#include <optional>
+
+#include "scheduler.hpp"
+#include "deferred_queue.hpp"
+#include "../debug/trace.hpp"
+
+/* The schedulers of an application and the loop that runs them.
+
+   Each pass runs the ready work in this order:
+
+     1. deferred()  Work deferred by the ISRs.
+     2. main()      Co-routines waiting on `co_await executor.main()`.
+     3. priority()  The highest priority co-routine.
+     4. delay()     The co-routines with an expired delay.
+
+   Passes are repeated until there is no ready work, then the executor idles until the next delay expires
+   or an interrupt. isr() is not run by the loop, it is resumed from the interrupt handler by resume_isr().
+
+   The idle policy is abstracted by IDLE:
+
+     IDLE::wait(std::optional<duration> delay, idle_test)
+         With interrupts disabled, if idle_test() returns true, sleep until an interrupt or the delay expires.
+
+   e.g. mtimer_idle in platform/executor-idle-mtimer.hpp
+
+   @tparam IDLE       Idle policy.
+   @tparam CLOCK_T    Clock of the delay scheduler, e.g. mtimer_clock.
+   @tparam MAX_TASKS  Maximum number of entries in each scheduler, must be a power of 2 for the deferred queue.
+
+ */
+template<class IDLE, class CLOCK_T, std::size_t MAX_TASKS = 8>
+class executor {
+  public:
+    using isr_scheduler = scheduler_unordered<MAX_TASKS>;
+    using main_scheduler = scheduler_unordered<MAX_TASKS>;
+    using priority_scheduler = scheduler_ordered<schedule_by_priority, MAX_TASKS>;
+    using delay_scheduler = scheduler_ordered<schedule_by_delay<CLOCK_T>, MAX_TASKS>;
+    using deferred_work_queue = deferred_queue<MAX_TASKS>;
+    using duration = typename CLOCK_T::duration;
+
+    explicit executor(IDLE& idle)
+        : idle_{ idle } {}
+
+    // The executor is intended to be instanciated once.
+    executor(const executor&) = delete;
+    executor(executor&&) = delete;
+    executor& operator=(const executor&) = delete;
+    executor& operator=(executor&&) = delete;
+
+    /** Co-routines resumed by the interrupt handler, see resume_isr(). */
+    isr_scheduler& isr(void) noexcept {
+        return isr_;
+    }
+    /** Work posted by the interrupt handlers, run first in each pass. */
+    deferred_work_queue& deferred(void) noexcept {
+        return deferred_;
+    }
+    /** Co-routines run on the next pass of the main loop. */
+    main_scheduler& main(void) noexcept {
+        return main_;
+    }
+    /** Co-routines run by priority, one per pass. */
+    priority_scheduler& priority(void) noexcept {
+        return priority_;
+    }
+    /** Co-routines run after a delay. */
+    delay_scheduler& delay(void) noexcept {
+        return delay_;
+    }
+
+    /** Resume the co-routines waiting on isr(), called from the interrupt handler.
+     */
+    void resume_isr(void) {
+        isr_.resume();
+    }
+
+    /** Run one pass over the schedulers.
+        @retval true Work was run.
+     */
+    bool run_ready(void) {
+        bool ran = deferred_.drain();
+        if (!main_.empty()) {
+            main_.resume();
+            ran = true;
+        }
+        // All entries are ready at the lowest priority, so any pending entry was run.
+        auto [priority_pending, priority_next] = priority_.resume(schedule_by_priority{ std::numeric_limits<int>::min() });
+        (void)priority_next;
+        ran |= priority_pending;
+        // The delay list is in order of expiry, if an entry was run there is no next wake up.
+        auto [delay_pending, delay_next] = delay_.resume(schedule_by_delay<CLOCK_T>{});
+        ran |= delay_pending && !delay_next;
+        next_wake_ = delay_next;
+        return ran;
+    }
+
+    /** Run the ready work until there is none, then idle until the next delay or an interrupt.
+        @retval true Co-routines are waiting in the main loop schedulers.
+     */
+    bool run_once(void) {
+        TRACE_TIMESTAMP(static_cast<trace_timestamp_t>(CLOCK_T::now().time_since_epoch().count()));
+        while (run_ready()) {
+        }
+        const bool pending = !(main_.empty() && priority_.empty() && delay_.empty() && deferred_.empty());
+        TRACE_VALUE(coro_pending, pending);
+        std::optional<duration> delay;
+        if (next_wake_) {
+            delay = next_wake_->delay();
+            TRACE_VALUE(next_wake_delay, static_cast<trace_timestamp_t>(delay->count()));
+        }
+        idle_.wait(delay, [this]() {
+            // Called with interrupts disabled, don't sleep if an ISR added work.
+            return deferred_.empty() && main_.empty();
+        });
+        return pending;
+    }
+
+    /** Run the main loop, does not return.
+     */
+    [[noreturn]] void run(void) {
+        while (true) {
+            run_once();
+        }
+    }
+
+  private:
+    IDLE& idle_;
+    isr_scheduler isr_;
+    deferred_work_queue deferred_;
+    main_scheduler main_;
+    priority_scheduler priority_;
+    delay_scheduler delay_;
+    std::optional<schedule_by_delay<CLOCK_T>> next_wake_;
+};
+
+#endif// EXECUTOR_HPP
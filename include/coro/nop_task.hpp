@@ -21,7 +21,7 @@
 
 namespace {
 #ifdef HOST_EMULATION
-    static constexpr size_t TASK_HEAP_SIZE = 4096;
+    static constexpr size_t TASK_HEAP_SIZE = 16384;
 #else
     static constexpr size_t TASK_HEAP_SIZE = 512;
 #endif
@@ -131,16 +131,18 @@ struct nop_task_promise_type {
 
         Allocate within a local array. Allocation is once off, so
         this is only appropraite for a static set of tasks.
+        The index is atomic so co-routines can be created on any hart.
 
     */
     static void* operator new(std::size_t size) noexcept {
-        if ((task_heap_index_ + size) < TASK_HEAP_SIZE) {
+        auto index = task_heap_index_.load(std::memory_order_relaxed);
+        do {
+            if ((index + size) >= TASK_HEAP_SIZE) {
+                return nullptr;
+            }
             // Simply allocate the next region in the task heap
-            auto retval = static_cast<void*>(&task_heap_[task_heap_index_]);
-            task_heap_index_ += size;
-            return retval;
-        }
-        return nullptr;
+        } while (!task_heap_index_.compare_exchange_weak(index, index + size, std::memory_order_relaxed));
+        return static_cast<void*>(&task_heap_[index]);
     }
     static void operator delete(void* ptr) {
         // TODO - This implementation only allows for a fixed number of tasks.
@@ -148,7 +150,7 @@ struct nop_task_promise_type {
     }
 
     inline static std::array<std::byte, TASK_HEAP_SIZE> task_heap_;
-    inline static std::size_t task_heap_index_{ 0 };
+    inline static std::atomic<std::size_t> task_heap_index_{ 0 };
 
   private:
 #ifdef HOST_EMULATION
@@ -0,0 +1,54 @@
+/*
+   Per-hart instances of a scheduler or driver.
+
+   SPDX-License-Identifier: Unlicense
+
+   https://five-embeddev.com/
+
+*/
+
+#ifndef PER_HART_HPP
+#define PER_HART_HPP
+
+#include <array>
+#include <cstddef>
+
+/* One instance of T for each hart, e.g. a scheduler_delay per hart so
+   timer driven co-routines on different harts don't share a timer compare.
+
+   Only the hart that owns an instance should access it, there is no locking.
+
+   @tparam T      The per-hart type, default constructed.
+   @tparam HART   Hart identity, provides static id(), e.g. riscv::smp::this_hart.
+   @tparam HARTS  Number of harts.
+
+ */
+template<class T, class HART, std::size_t HARTS>
+class per_hart {
+  public:
+    static constexpr std::size_t hart_count = HARTS;
+
+    // Defaults
+    per_hart() {}
+
+    // Intended to be instanciated once.
+    per_hart(const per_hart&) = delete;
+    per_hart(per_hart&&) = delete;
+    per_hart& operator=(const per_hart&) = delete;
+    per_hart& operator=(per_hart&&) = delete;
+
+    /** The instance of the calling hart. */
+    T& local(void) noexcept {
+        return instances_[HART::id() % HARTS];
+    }
+
+    /** The instance of a hart. */
+    T& operator[](std::size_t hart) noexcept {
+        return instances_[hart % HARTS];
+    }
+
+  private:
+    std::array<T, HARTS> instances_;
+};
+
+#endif// PER_HART_HPP
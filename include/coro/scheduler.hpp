@@ -18,14 +18,19 @@
 #include <chrono>
 #include <array>
 #include <optional>
+#include <type_traits>
 
 #include "../debug/trace.hpp"
+#include "../debug/latency.hpp"
+#include "../debug/task_accounting.hpp"
+#include "../debug/jitter.hpp"
 
 #if defined(HOST_EMULATION)
 #include <iostream>
 #endif
 
 #include "static_list.hpp"
+#include "deadline_monitor.hpp"
 
 using namespace std::literals::chrono_literals;
 
@@ -60,6 +65,13 @@ class schedule_by_delay {
         : expires_{ now() + duration_cast<duration>(delay) } {
     }
 
+    /** Schedule a coroutine to wakeup after delay microseconds, and check it is resumed within its deadline.
+     */
+    schedule_by_delay(std::chrono::microseconds delay, deadline_monitor* monitor)
+        : expires_{ now() + duration_cast<duration>(delay) }
+        , monitor_{ monitor } {
+    }
+
     /** Schedule a coroutine to wakeup immediately.
      */
     schedule_by_delay()
@@ -82,8 +94,18 @@ class schedule_by_delay {
         return 0s;
     }
 
+    /** Called when the co-routine is resumed, record how late it is.
+     */
+    void woken(void) const {
+        WAKEUP_JITTER(now() - expires_);
+        if (monitor_) {
+            monitor_->woken(duration_cast<std::chrono::microseconds>(now() - expires_));
+        }
+    }
+
   private:
     time_point expires_;// Absolute time point
+    deadline_monitor* monitor_{ nullptr };
 };
 
 
@@ -103,6 +125,10 @@ class schedule_by_priority {
         return (priority_ >= current_state.priority_);
     }
 
+    int priority(void) const {
+        return priority_;
+    }
+
   private:
     int priority_;
 };
@@ -204,6 +230,15 @@ class scheduler_ordered {
         return WAKE_CONDITION_T{ arg };
     }
 
+    /** Create a condition for waking this type of scheduled object, with a deadline monitor.
+     */
+    template<typename T>
+    static WAKE_CONDITION_T make_condition(T& arg, deadline_monitor* monitor)
+        requires std::is_constructible_v<WAKE_CONDITION_T, T&, deadline_monitor*>
+    {
+        return WAKE_CONDITION_T{ arg, monitor };
+    }
+
     /** Insert an entry to be scheduled to run after a given delay.
 
        @param handle            C++ Co-routine handle to be scheduled.
@@ -219,6 +254,7 @@ class scheduler_ordered {
             }
             ++i;
         }
+        TRACE_EVENT(scheduler_insert, handle.address());
         waiting_.emplace(i, std::move(schedule_entry<WAKE_CONDITION_T>{ handle, wake_condition }));
     }
 
@@ -239,9 +275,6 @@ class scheduler_ordered {
 
         bool pending{ false };
         auto i = waiting_.begin();
-        uint16_t j = 0;
-        TRACE_VALUE(scheduler_update_i, j);
-        TRACE_VALUE(scheduler_update_r, 0);
         while (i != waiting_.end()) {
             // We have seen at least one pending co-routine.
             pending = true;
@@ -251,31 +284,34 @@ class scheduler_ordered {
                 std::optional<WAKE_CONDITION_T> c{ i->wake_condition() };
                 auto handle{ i->handle() };
                 waiting_.erase(i);
+                // Wake conditions such as schedule_by_delay can record the wakeup.
+                if constexpr (requires { c->woken(); }) {
+                    c->woken();
+                }
 
                 // Don't continue iteration here, let the caller descide what to do.
                 // It's quite possible something else was scheduled in the above call.
 
                 // Return true so it calls us until all entries have
                 // been visited and seen to be done..
-                TRACE_VALUE_FLAG(scheduler_update_r, 1);
+                TRACE_EVENT(scheduler_wake, this);
+                LATENCY_DISPATCH();
+                TRACE_EVENT(coro_resume, handle.address());
+                TASK_ACCOUNT_RESUME();
                 handle.resume();
+                TASK_ACCOUNT_SUSPEND(handle);
+                TRACE_EVENT(coro_suspend, handle.address());
                 return { true, priority_condition };// Does not return
             }
             else {
                 // Keep track of the soonest scheduled co-routine.
-                if (!priority_condition || priority_condition->ready_to_wake(i->wake_condition())) {
+                if (!priority_condition || i->ready_to_wake(*priority_condition)) {
                     priority_condition = i->wake_condition();
-                    TRACE_VALUE_FLAG(scheduler_update_r, 2);
-                }
-                else {
-                    TRACE_VALUE_FLAG(scheduler_update_r, 4);
                 }
             }
             ++i;
-            TRACE_VALUE(scheduler_update_i, ++j);
         }
         // No entry is active, but there are pending entries and the caller requested we block.
-        TRACE_VALUE_FLAG(scheduler_update_r, 8);
         return { pending, priority_condition };
     }
 
@@ -324,6 +360,7 @@ class scheduler_unordered {
 
     */
     void insert(std::coroutine_handle<> handle) {
+        TRACE_EVENT(scheduler_insert, handle.address());
         waiting_.emplace_back(std::move(handle));
     }
 
@@ -335,7 +372,13 @@ class scheduler_unordered {
         while (!waiting_.empty()) {
             auto handle{ *waiting_.begin() };
             waiting_.pop_front();
+            TRACE_EVENT(scheduler_wake, this);
+            LATENCY_DISPATCH();
+            TRACE_EVENT(coro_resume, handle.address());
+            TASK_ACCOUNT_RESUME();
             handle.resume();
+            TASK_ACCOUNT_SUSPEND(handle);
+            TRACE_EVENT(coro_suspend, handle.address());
         }
     }
 
@@ -0,0 +1,174 @@
+/*
+   Priority scheduling of co-routines with aging, so low priority co-routines are not starved.
+
+   SPDX-License-Identifier: Unlicense
+
+   https://five-embeddev.com/
+
+*/
+
+
+#ifndef SCHEDULER_AGING_HPP
+#define SCHEDULER_AGING_HPP
+
+#include <coroutine>
+#include <array>
+#include <cstdint>
+#include <optional>
+
+#include "scheduler.hpp"
+
+/** Wait statistics of one priority level, counted in dispatches of the scheduler.
+ */
+struct priority_wait_stats {
+    std::uint32_t count{ 0 };     // Co-routines of this priority that were run.
+    std::uint32_t max_wait{ 0 };  // Worst number of other co-routines run while waiting.
+    std::uint64_t total_wait{ 0 };// Sum of waits, for the average.
+};
+
+/* A container for a set of co-routines scheduled by priority, where waiting co-routines age.
+
+   The effective priority of an entry is its priority plus one for each AGE_STEP
+   co-routines that were run while it waited, up to AGE_LIMIT. So a co-routine more than
+   AGE_LIMIT above a background co-routine is never delayed by it, and a steady stream of
+   work at a higher priority can't starve it. AGE_STEP = 0 disables aging, then this
+   runs co-routines in the same order as scheduler_priority.
+
+   Age is counted in dispatches rather than time, so it is integer only and needs no clock.
+   Equal effective priorities run in the order they were inserted.
+
+   This does NOT match any of the co-routine concepts.
+
+   @tparam AGE_STEP         Dispatches per step of aging, 0 to disable.
+   @tparam AGE_LIMIT        Maximum steps an entry can be raised.
+   @tparam PRIORITY_LEVELS  Number of priority levels with wait statistics, higher priorities share the last level.
+   @tparam MAX_TASKS        A fixed array is used to schedule entries. This is the maximum number of entries.
+
+ */
+template<std::uint32_t AGE_STEP = 4,
+         int AGE_LIMIT = 2,
+         std::size_t PRIORITY_LEVELS = 8,
+         std::size_t MAX_TASKS = 10>
+class scheduler_priority_aging {
+
+  public:
+    using CONDITION = schedule_by_priority;
+    // Defaults
+    scheduler_priority_aging() {}
+
+    // The scheduler_priority_aging is intended to be instanciated once.
+    scheduler_priority_aging(const scheduler_priority_aging&) = delete;
+    scheduler_priority_aging(scheduler_priority_aging&&) = delete;
+    scheduler_priority_aging& operator=(const scheduler_priority_aging&) = delete;
+    scheduler_priority_aging& operator=(scheduler_priority_aging&&) = delete;
+
+    /** Test for an empty schedule list .
+        @retval true There are no co-routines scheduled to wake up.
+     */
+    bool empty() const noexcept {
+        return waiting_.empty();
+    }
+
+    /** Create a condition for waking this type of scheduled object.
+     */
+    template<typename T>
+    static CONDITION make_condition(T& arg) {
+        return CONDITION{ arg };
+    }
+
+    /** Insert an entry to be scheduled at a priority.
+
+       @param handle            C++ Co-routine handle to be scheduled.
+       @param wake_condition    Priority of the co-routine.
+
+    */
+    void insert(std::coroutine_handle<> handle,
+                const CONDITION& wake_condition) {
+        TRACE_EVENT(scheduler_insert, handle.address());
+        waiting_.emplace_back(entry{ handle, wake_condition, dispatched_ });
+    }
+
+    /** Run the waiting co-routine with the highest effective priority, if it is ready to wake.
+
+        @param ready_condition Run an entry with an effective priority at or above this.
+        @retval (more routines are pending, highest effective priority that is waiting)
+    */
+    std::pair<bool, std::optional<CONDITION>>
+        resume(const CONDITION& ready_condition) {
+        auto best = waiting_.end();
+        int best_priority{ 0 };
+        for (auto i = waiting_.begin(); i != waiting_.end(); ++i) {
+            const int priority = effective_priority(*i);
+            if ((best == waiting_.end()) || (priority > best_priority)) {
+                best = i;
+                best_priority = priority;
+            }
+        }
+        if (best == waiting_.end()) {
+            return { false, std::nullopt };
+        }
+        if (!CONDITION{ best_priority }.ready_to_wake(ready_condition)) {
+            return { true, CONDITION{ best_priority } };
+        }
+
+        auto handle{ best->handle };
+        auto& stats = stats_[level(best->condition.priority())];
+        const std::uint32_t waited = dispatched_ - best->enqueued;
+        stats.count++;
+        stats.total_wait += waited;
+        if (waited > stats.max_wait) {
+            stats.max_wait = waited;
+        }
+        waiting_.erase(best);
+        dispatched_++;
+
+        TRACE_EVENT(scheduler_wake, this);
+        LATENCY_DISPATCH();
+        TRACE_EVENT(coro_resume, handle.address());
+        TASK_ACCOUNT_RESUME();
+        handle.resume();
+        TASK_ACCOUNT_SUSPEND(handle);
+        TRACE_EVENT(coro_suspend, handle.address());
+        return { true, std::nullopt };
+    }
+
+    /** Wait statistics of a priority level.
+     */
+    const priority_wait_stats& wait_stats(int priority) const noexcept {
+        return stats_[level(priority)];
+    }
+
+  private:
+    struct entry {
+        std::coroutine_handle<> handle;
+        CONDITION condition;
+        std::uint32_t enqueued;// Dispatch count when inserted.
+    };
+
+    int effective_priority(const entry& e) const noexcept {
+        int age{ 0 };
+        if constexpr (AGE_STEP != 0) {
+            const std::uint32_t steps = (dispatched_ - e.enqueued) / AGE_STEP;
+            age = (steps < static_cast<std::uint32_t>(AGE_LIMIT)) ? static_cast<int>(steps) : AGE_LIMIT;
+        }
+        return e.condition.priority() + age;
+    }
+
+    static std::size_t level(int priority) noexcept {
+        if (priority < 0) {
+            return 0;
+        }
+        if (static_cast<std::size_t>(priority) >= PRIORITY_LEVELS) {
+            return PRIORITY_LEVELS - 1;
+        }
+        return static_cast<std::size_t>(priority);
+    }
+
+    //! Set of waiting tasks, in the order they were inserted
+    static_list<entry, MAX_TASKS> waiting_;
+    //! Number of co-routines run, the clock for aging.
+    std::uint32_t dispatched_{ 0 };
+    std::array<priority_wait_stats, PRIORITY_LEVELS> stats_{};
+};
+
+#endif// SCHEDULER_AGING_HPP
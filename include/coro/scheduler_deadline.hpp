@@ -0,0 +1,223 @@
+/*
+   Earliest deadline first (EDF) scheduling of co-routines.
+
+   Each co-routine is released at a point in time and has an absolute deadline,
+   of the released co-routines the one with the earliest deadline runs first.
+
+   SPDX-License-Identifier: Unlicense
+
+   https://five-embeddev.com/
+
+*/
+
+
+#ifndef SCHEDULER_DEADLINE_HPP
+#define SCHEDULER_DEADLINE_HPP
+
+#include <coroutine>
+#include <chrono>
+#include <cstdint>
+#include <optional>
+
+#include "scheduler.hpp"
+
+/** Wake condition with a release time and an absolute deadline.
+
+    A coroutine is ready to wake once it has been released, the scheduler orders
+    ready coroutines by deadline.
+ */
+template<typename CLOCK_T>
+class schedule_by_deadline {
+  public:
+    using duration = typename CLOCK_T::duration;
+    using time_point = typename CLOCK_T::time_point;
+
+    static time_point now() {
+        return CLOCK_T::now();
+    }
+
+    /** Schedule a coroutine to be released after a delay, and to complete within deadline of the release.
+        @param release   Delay until the coroutine is released.
+        @param deadline  Deadline relative to the release time.
+        @param stats     Optional statistics of the task, updated when it is run.
+     */
+    schedule_by_deadline(std::chrono::microseconds release,
+                         std::chrono::microseconds deadline,
+                         deadline_stats* stats = nullptr)
+        : release_{ now() + duration_cast<duration>(release) }
+        , deadline_{ release_ + duration_cast<duration>(deadline) }
+        , stats_{ stats } {
+    }
+
+    /** The current state, released and due now.
+     */
+    schedule_by_deadline()
+        : release_{ now() }
+        , deadline_{ release_ } {
+    }
+
+    /** Compare to the current state, has this coroutine been released.
+     */
+    bool ready_to_wake(const schedule_by_deadline& current_state) const {
+        return (current_state.release_ >= release_);
+    }
+
+    /** Compare to another condition, is this deadline earlier.
+     */
+    bool earlier_deadline(const schedule_by_deadline& other) const {
+        return (deadline_ < other.deadline_);
+    }
+
+    /** Compare to the current state, has the deadline passed.
+     */
+    bool missed(const schedule_by_deadline& current_state) const {
+        return (current_state.release_ > deadline_);
+    }
+
+    /** Time between the deadline and the current state, zero if the deadline has not passed.
+     */
+    duration lateness(const schedule_by_deadline& current_state) const {
+        if (missed(current_state)) {
+            return current_state.release_ - deadline_;
+        }
+        return duration::zero();
+    }
+
+    /** Return the time to wait until this is released.
+     */
+    typename CLOCK_T::duration delay(void) {
+        auto t_now = now();
+        if (release_ > t_now) {
+            return release_ - t_now;
+        }
+        return 0s;
+    }
+
+    deadline_stats* stats(void) const {
+        return stats_;
+    }
+
+  private:
+    time_point release_; // Absolute time the coroutine is released.
+    time_point deadline_;// Absolute time the coroutine should have run by.
+    deadline_stats* stats_{ nullptr };
+};
+
+
+/* A container for a set of co-routines scheduled by earliest deadline first.
+
+   The waiting list is sorted by deadline, so the first released entry has the earliest deadline.
+   Entries with the same deadline run in the order they were inserted.
+
+   This does NOT match any of the co-routine concepts.
+
+   @tparam CLOCK_T    Clock for release time and deadlines, e.g. mtimer_clock.
+   @tparam MAX_TASKS  A fixed array is used to schedule entries. This is the maximum number of entries.
+
+ */
+template<typename CLOCK_T,
+         std::size_t MAX_TASKS = 10>
+class scheduler_deadline {
+
+  public:
+    using CONDITION = schedule_by_deadline<CLOCK_T>;
+    // Defaults
+    scheduler_deadline() {}
+
+    // The scheduler_deadline is intended to be instanciated once.
+    scheduler_deadline(const scheduler_deadline&) = delete;
+    scheduler_deadline(scheduler_deadline&&) = delete;
+    scheduler_deadline& operator=(const scheduler_deadline&) = delete;
+    scheduler_deadline& operator=(scheduler_deadline&&) = delete;
+
+    /** Test for an empty schedule list .
+        @retval true There are no co-routines scheduled to wake up.
+     */
+    bool empty() const noexcept {
+        return waiting_.empty();
+    }
+
+    /** Number of times any co-routine was run after its deadline.
+     */
+    std::uint32_t missed() const noexcept {
+        return missed_;
+    }
+
+    /** Insert an entry, ordered by deadline.
+
+       @param handle            C++ Co-routine handle to be scheduled.
+       @param wake_condition    Release time and deadline.
+
+    */
+    void insert(std::coroutine_handle<> handle,
+                const CONDITION& wake_condition) {
+        auto i = waiting_.begin();
+        while (i != waiting_.end()) {
+            if (wake_condition.earlier_deadline(i->wake_condition())) {
+                break;
+            }
+            ++i;
+        }
+        TRACE_EVENT(scheduler_insert, handle.address());
+        waiting_.emplace(i, std::move(schedule_entry<CONDITION>{ handle, wake_condition }));
+    }
+
+    /** Run the released co-routine with the earliest deadline.
+        If none is released return the condition of the next release, to wait for it.
+
+        @param ready_condition The current state, e.g. CONDITION{}.
+        @retval (more routines are pending, next release to wait for)
+    */
+    std::pair<bool, std::optional<CONDITION>>
+        resume(const CONDITION& ready_condition) {
+        std::optional<CONDITION> next_release;
+
+        bool pending{ false };
+        auto i = waiting_.begin();
+        while (i != waiting_.end()) {
+            pending = true;
+
+            if (i->ready_to_wake(ready_condition)) {
+                const CONDITION c{ i->wake_condition() };
+                auto handle{ i->handle() };
+                waiting_.erase(i);
+
+                const bool missed = c.missed(ready_condition);
+                if (missed) {
+                    missed_++;
+                }
+                if (auto stats = c.stats()) {
+                    stats->released++;
+                    if (missed) {
+                        stats->missed++;
+                        auto lateness = duration_cast<std::chrono::microseconds>(c.lateness(ready_condition));
+                        if (lateness > stats->max_lateness) {
+                            stats->max_lateness = lateness;
+                        }
+                    }
+                }
+                TRACE_EVENT(scheduler_wake, this);
+                LATENCY_DISPATCH();
+                TRACE_EVENT(coro_resume, handle.address());
+                TASK_ACCOUNT_RESUME();
+                handle.resume();
+                TASK_ACCOUNT_SUSPEND(handle);
+                TRACE_EVENT(coro_suspend, handle.address());
+                return { true, next_release };
+            }
+            else if (!next_release || i->ready_to_wake(*next_release)) {
+                // Keep track of the soonest release.
+                next_release = i->wake_condition();
+            }
+            ++i;
+        }
+        return { pending, next_release };
+    }
+
+  private:
+    //! Set of waiting tasks, sorted by deadline
+    static_list<schedule_entry<CONDITION>, MAX_TASKS> waiting_;
+    std::uint32_t missed_{ 0 };
+};
+
+#endif// SCHEDULER_DEADLINE_HPP
@@ -0,0 +1,397 @@
+/*
+   Multi-hart (SMP) executor with per-hart run queues and work stealing.
+
+   Each hart runs co-routines from its own run queue, when the queue is
+   empty the hart steals ready co-routines from the other harts.
+
+   SPDX-License-Identifier: Unlicense
+
+   https://five-embeddev.com/
+
+*/
+
+#ifndef SMP_EXECUTOR_HPP
+#define SMP_EXECUTOR_HPP
+
+#include "scheduler.hpp"
+
+#include <coroutine>
+#include <atomic>
+#include <array>
+#include <cstddef>
+#include <cstdint>
+
+#if defined(HOST_EMULATION)
+/** Align per-hart state to the cache line to avoid false sharing */
+static constexpr std::size_t SMP_CACHE_LINE_SIZE = 64;
+#else
+static constexpr std::size_t SMP_CACHE_LINE_SIZE = sizeof(std::uintptr_t);
+#endif
+
+/* Bounded lock free multi producer, multi consumer queue of ready co-routines.
+
+   Any hart can insert into the queue, and any hart can take from the queue,
+   i.e. the owner or a hart that is stealing work.
+   (Dmitry Vyukov's bounded MPMC queue, one sequence number per cell).
+
+   @tparam MAX_TASKS   Maximum number of queued co-routines, must be a power of 2 and at least 2.
+
+ */
+template<std::size_t MAX_TASKS>
+class smp_run_queue {
+    static_assert((MAX_TASKS & (MAX_TASKS - 1)) == 0, "MAX_TASKS must be a power of 2");
+    static_assert(MAX_TASKS >= 2, "MAX_TASKS must be at least 2");
+    static_assert(std::atomic<std::size_t>::is_always_lock_free, "Requires lock free atomics");
+    static constexpr std::size_t INDEX_MASK = MAX_TASKS - 1;
+
+  public:
+    smp_run_queue() {
+        for (std::size_t i = 0; i < MAX_TASKS; i++) {
+            cells_[i].sequence.store(i, std::memory_order_relaxed);
+        }
+    }
+
+    // The run queue is intended to be instanciated once.
+    smp_run_queue(const smp_run_queue&) = delete;
+    smp_run_queue(smp_run_queue&&) = delete;
+    smp_run_queue& operator=(const smp_run_queue&) = delete;
+    smp_run_queue& operator=(smp_run_queue&&) = delete;
+
+    /** Add a ready co-routine.
+        @retval false  The queue is full.
+     */
+    bool push(std::coroutine_handle<> handle) noexcept {
+        auto pos = tail_.load(std::memory_order_relaxed);
+        cell* c;
+        while (true) {
+            c = &cells_[pos & INDEX_MASK];
+            const auto sequence = c->sequence.load(std::memory_order_acquire);
+            const auto diff = static_cast<std::intptr_t>(sequence) - static_cast<std::intptr_t>(pos);
+            if (diff == 0) {
+                if (tail_.compare_exchange_weak(pos, pos + 1, std::memory_order_relaxed)) {
+                    break;
+                }
+            }
+            else if (diff < 0) {
+                return false;
+            }
+            else {
+                pos = tail_.load(std::memory_order_relaxed);
+            }
+        }
+        c->handle = handle;
+        c->sequence.store(pos + 1, std::memory_order_release);
+        return true;
+    }
+
+    /** Take the oldest ready co-routine.
+        @retval false  The queue is empty.
+     */
+    bool pop(std::coroutine_handle<>& handle) noexcept {
+        auto pos = head_.load(std::memory_order_relaxed);
+        cell* c;
+        while (true) {
+            c = &cells_[pos & INDEX_MASK];
+            const auto sequence = c->sequence.load(std::memory_order_acquire);
+            const auto diff = static_cast<std::intptr_t>(sequence) - static_cast<std::intptr_t>(pos + 1);
+            if (diff == 0) {
+                if (head_.compare_exchange_weak(pos, pos + 1, std::memory_order_relaxed)) {
+                    break;
+                }
+            }
+            else if (diff < 0) {
+                return false;
+            }
+            else {
+                pos = head_.load(std::memory_order_relaxed);
+            }
+        }
+        handle = c->handle;
+        c->sequence.store(pos + MAX_TASKS, std::memory_order_release);
+        return true;
+    }
+
+    /** Test if the queue is empty, only a snapshot when other harts are running. */
+    bool empty(void) const noexcept {
+        return head_.load(std::memory_order_acquire) == tail_.load(std::memory_order_acquire);
+    }
+
+  private:
+    struct cell {
+        std::atomic<std::size_t> sequence;
+        std::coroutine_handle<> handle;
+    };
+    std::array<cell, MAX_TASKS> cells_;
+    alignas(SMP_CACHE_LINE_SIZE) std::atomic<std::size_t> head_{ 0 };
+    alignas(SMP_CACHE_LINE_SIZE) std::atomic<std::size_t> tail_{ 0 };
+};
+
+/** Per-hart executor statistics, only written by the hart.
+ */
+struct smp_hart_stats {
+    //! Co-routines resumed by this hart.
+    std::uint32_t resumed;
+    //! Co-routines this hart took from other harts.
+    std::uint32_t stolen;
+    //! Times this hart was woken from idle().
+    std::uint32_t wakeups;
+};
+
+/* SMP executor. Runs ready co-routines on a number of harts.
+
+   A co-routine that awaits the executor is added to the run queue of the
+   hart it is running on. A hart runs the co-routines in its own queue
+   first, and when it is empty steals from the other harts, starting with
+   the next hart so the thieves are spread over the victims.
+
+   A hart with no work calls idle() and sleeps until it is woken by an
+   inter-processor interrupt. Adding work wakes an idle hart, so it can
+   steal the work, and resume_on() wakes the hart it moves the co-routine to.
+
+   @tparam HART       Hart identity and wakeup, provides static id(), wake(hart) and wait(),
+                      e.g. riscv::smp::this_hart.
+   @tparam HARTS      Number of harts, each has a run queue.
+   @tparam MAX_TASKS  Run queue size per hart, must be a power of 2 and at least 2.
+
+ */
+template<class HART, std::size_t HARTS = 4, std::size_t MAX_TASKS = 8>
+class smp_executor {
+    static_assert(HARTS > 0, "At least one hart is required");
+    static_assert(HARTS <= 32, "The idle harts are a 32 bit mask");
+
+  public:
+    static constexpr std::size_t hart_count = HARTS;
+
+    // Defaults
+    smp_executor() {}
+
+    // The executor is intended to be instanciated once.
+    smp_executor(const smp_executor&) = delete;
+    smp_executor(smp_executor&&) = delete;
+    smp_executor& operator=(const smp_executor&) = delete;
+    smp_executor& operator=(smp_executor&&) = delete;
+
+    /** Add a ready co-routine to the run queue of a hart.
+        If the queue is full the co-routine is added to the next hart with space.
+        @retval false  All run queues are full.
+     */
+    bool insert(std::coroutine_handle<> handle, std::size_t hart) noexcept {
+        hart = hart % HARTS;
+        TRACE_EVENT(scheduler_insert, handle.address());
+        for (std::size_t i = 0; i < HARTS; i++) {
+            if (harts_[(hart + i) % HARTS].queue.push(handle)) {
+                wake_idle((hart + i) % HARTS, true);
+                return true;
+            }
+        }
+        return false;
+    }
+
+    /** Add a co-routine that must be resumed on a hart, it is not stolen by other harts.
+        The hart is woken if it is idle.
+        @retval false  The pinned queue of the hart is full.
+     */
+    bool insert_on(std::coroutine_handle<> handle, std::size_t hart) noexcept {
+        hart = hart % HARTS;
+        if (!harts_[hart].pinned.push(handle)) {
+            return false;
+        }
+        wake_idle(hart, false);
+        return true;
+    }
+
+    /** The calling hart */
+    static std::size_t current_hart(void) noexcept {
+        return HART::id() % HARTS;
+    }
+
+    /** Add a ready co-routine to the run queue of the calling hart. */
+    bool insert(std::coroutine_handle<> handle) noexcept {
+        return insert(handle, HART::id());
+    }
+
+    /** Run one co-routine on a hart, from its own queue or stolen from another hart.
+        @retval false  There was no ready co-routine.
+     */
+    bool run_one(std::size_t hart) {
+        std::coroutine_handle<> handle;
+        auto& self = harts_[hart % HARTS];
+        if (!self.pinned.pop(handle) && !self.queue.pop(handle)) {
+            if (!steal(hart, handle)) {
+                return false;
+            }
+            self.stats.stolen++;
+        }
+        self.stats.resumed++;
+        TRACE_EVENT(scheduler_wake, this);
+        LATENCY_DISPATCH();
+        TRACE_EVENT(coro_resume, handle.address());
+        TASK_ACCOUNT_RESUME();
+        handle.resume();
+        TASK_ACCOUNT_SUSPEND(handle);
+        TRACE_EVENT(coro_suspend, handle.address());
+        return true;
+    }
+
+    /** Run co-routines on the calling hart until there are none ready on any hart.
+        @return The number of co-routines resumed.
+     */
+    std::size_t resume(void) {
+        const auto hart = HART::id();
+        std::size_t count{ 0 };
+        while (run_one(hart)) {
+            count++;
+        }
+        return count;
+    }
+
+    /** Sleep until woken, called by a hart when resume() found no work.
+        Returns immediately if work was added since resume() returned.
+     */
+    void idle(void) {
+        const auto hart = HART::id() % HARTS;
+        const auto bit = std::uint32_t{ 1 } << hart;
+        idle_.fetch_or(bit, std::memory_order_acq_rel);
+        if (harts_[hart].pinned.empty() && empty()) {
+            HART::wait();
+            harts_[hart].stats.wakeups++;
+        }
+        idle_.fetch_and(~bit, std::memory_order_acq_rel);
+    }
+
+    /** Wake all other harts, e.g. to stop the harts. */
+    void wake_all(void) {
+        const auto self = HART::id() % HARTS;
+        for (std::size_t hart = 0; hart < HARTS; hart++) {
+            if (hart != self) {
+                HART::wake(hart);
+            }
+        }
+    }
+
+    /** Continue the co-routine on a hart, i.e. co_await executor.resume_on(hart).
+     */
+    auto resume_on(std::size_t hart) noexcept;
+
+    /** Test if all run queues are empty, only a snapshot when other harts are running.
+        The pinned queues are not included, they can only be run by their hart.
+     */
+    bool empty(void) const noexcept {
+        for (const auto& h : harts_) {
+            if (!h.queue.empty()) {
+                return false;
+            }
+        }
+        return true;
+    }
+
+    /** Statistics of a hart, read when the hart is not running. */
+    const smp_hart_stats& stats(std::size_t hart) const noexcept {
+        return harts_[hart % HARTS].stats;
+    }
+
+  private:
+    /** Wake the hart that work was added to if it is idle.
+        If it is not idle and the work can be stolen, wake another idle hart.
+     */
+    void wake_idle(std::size_t hart, bool stealable) noexcept {
+        // Read-modify-write so the insert is ordered with the idle() update of the same mask,
+        // either the idle hart sees the work or this sees the idle hart.
+        const auto idle = idle_.fetch_or(0, std::memory_order_acq_rel);
+        if (idle == 0) {
+            return;
+        }
+        if (idle & (std::uint32_t{ 1 } << hart)) {
+            HART::wake(hart);
+        }
+        else if (stealable) {
+            HART::wake(static_cast<std::size_t>(__builtin_ctz(idle)));
+        }
+    }
+
+    bool steal(std::size_t hart, std::coroutine_handle<>& handle) noexcept {
+        for (std::size_t i = 1; i < HARTS; i++) {
+            if (harts_[(hart + i) % HARTS].queue.pop(handle)) {
+                return true;
+            }
+        }
+        return false;
+    }
+
+    struct alignas(SMP_CACHE_LINE_SIZE) hart_state {
+        smp_run_queue<MAX_TASKS> queue;
+        smp_run_queue<MAX_TASKS> pinned;
+        smp_hart_stats stats{};
+    };
+    std::array<hart_state, HARTS> harts_;
+    std::atomic<std::uint32_t> idle_{ 0 };
+};
+
+/* A class that implements the Awaitable concept.
+   Suspends the co-routine and adds it to the run queue of the calling hart.
+   If all run queues are full the co-routine continues without suspending.
+
+   @tparam EXECUTOR The SMP executor.
+ */
+template<class EXECUTOR>
+struct awaitable_smp {
+    explicit awaitable_smp(EXECUTOR& executor)
+        : executor_{ executor } {
+    }
+
+    bool await_ready() noexcept(true) {
+        return false;
+    }
+    bool await_suspend(std::coroutine_handle<> handle) noexcept(true) {
+        return executor_.insert(handle);
+    }
+    void await_resume() noexcept(true) {
+        LATENCY_RESUME();
+    }
+
+  private:
+    EXECUTOR& executor_;
+};
+
+/* A class that implements the Awaitable concept.
+   Moves the co-routine to a hart, and wakes the hart with an inter-processor interrupt.
+   The co-routine continues without suspending if it is already on the hart,
+   or if the pinned queue of the hart is full.
+
+   @tparam EXECUTOR The SMP executor.
+ */
+template<class EXECUTOR>
+struct awaitable_resume_on {
+    awaitable_resume_on(EXECUTOR& executor, std::size_t hart)
+        : executor_{ executor }
+        , hart_{ hart } {
+    }
+
+    bool await_ready() noexcept(true) {
+        return executor_.current_hart() == hart_;
+    }
+    bool await_suspend(std::coroutine_handle<> handle) noexcept(true) {
+        return executor_.insert_on(handle, hart_);
+    }
+    void await_resume() noexcept(true) {
+        LATENCY_RESUME();
+    }
+
+  private:
+    EXECUTOR& executor_;
+    const std::size_t hart_;
+};
+
+template<class HART, std::size_t HARTS, std::size_t MAX_TASKS>
+auto smp_executor<HART, HARTS, MAX_TASKS>::resume_on(std::size_t hart) noexcept {
+    return awaitable_resume_on{ *this, hart % HARTS };
+}
+
+/** Allow the executor to be directly 'awaited' on, i.e. yield to other ready co-routines.
+ */
+template<class HART, std::size_t HARTS, std::size_t MAX_TASKS>
+auto operator co_await(smp_executor<HART, HARTS, MAX_TASKS>& executor) noexcept(true) {
+    return awaitable_smp{ executor };
+}
+
+#endif// SMP_EXECUTOR_HPP
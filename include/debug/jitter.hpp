@@ -0,0 +1,157 @@
+/*
+   Wakeup jitter of timer scheduled co-routines.
+
+   The lateness of each wakeup (resume time - scheduled time) is counted
+   in a log-linear histogram: each power of 2 range is split in
+   2^JITTER_SUB_BUCKET_BITS linear buckets, so the relative error is
+   bounded and the memory is fixed. Percentiles are read at runtime.
+
+   The hooks compile to nothing unless ENABLE_WAKEUP_JITTER is defined.
+
+   SPDX-License-Identifier: Unlicense
+
+   https://five-embeddev.com/
+
+*/
+
+#ifndef JITTER_HPP
+#define JITTER_HPP
+
+#include <cstdint>
+#include <bit>
+#include <chrono>
+
+#include "trace.hpp"
+
+#if defined(HOST_EMULATION)
+#include <cstdio>
+#endif
+
+#ifndef JITTER_SUB_BUCKET_BITS
+/** Linear buckets per power of 2 (log2), the bucket width is at most 1/2^bits of the value. */
+#define JITTER_SUB_BUCKET_BITS 3
+#endif
+
+/** Log-linear histogram of 32 bit values.
+ */
+template<unsigned int SUB_BITS = JITTER_SUB_BUCKET_BITS>
+struct log_linear_histogram {
+    static_assert(SUB_BITS < 16, "SUB_BITS is too large");
+    static constexpr std::uint32_t SUB_BUCKETS = 1u << SUB_BITS;
+    //! Values below 2^(SUB_BITS+1) have their own bucket, then SUB_BUCKETS per power of 2.
+    static constexpr std::uint32_t BUCKETS = (33 - SUB_BITS) * SUB_BUCKETS;
+
+    std::uint32_t count;
+    std::uint32_t min;
+    std::uint32_t max;
+    std::uint32_t histogram[BUCKETS];
+
+    /** Bucket of a value.
+     */
+    static constexpr std::uint32_t bucket(std::uint32_t value) noexcept {
+        const auto msb = static_cast<std::uint32_t>(std::bit_width(value));
+        if (msb <= SUB_BITS + 1) {
+            return value;
+        }
+        const std::uint32_t shift = msb - SUB_BITS - 1;
+        return (shift + 1) * SUB_BUCKETS + ((value >> shift) - SUB_BUCKETS);
+    }
+
+    /** Largest value in a bucket.
+     */
+    static constexpr std::uint32_t bucket_max(std::uint32_t index) noexcept {
+        if (index < 2 * SUB_BUCKETS) {
+            return index;
+        }
+        const std::uint32_t shift = index / SUB_BUCKETS - 1;
+        const std::uint64_t mantissa = (index % SUB_BUCKETS) + SUB_BUCKETS;
+        return static_cast<std::uint32_t>(((mantissa + 1) << shift) - 1);
+    }
+
+    /** Add a sample.
+     */
+    void add(std::uint32_t value) noexcept {
+        if (count == 0 || value < min) {
+            min = value;
+        }
+        if (value > max) {
+            max = value;
+        }
+        count++;
+        histogram[bucket(value)]++;
+    }
+
+    /** Value that parts/whole of the samples are at or below, e.g. percentile(999, 1000) is p99.9.
+        The upper bound of the bucket is returned, limited to the largest sample. 0 if there are no samples.
+     */
+    std::uint32_t percentile(std::uint32_t parts, std::uint32_t whole = 100) const noexcept {
+        if (count == 0) {
+            return 0;
+        }
+        // Rank of the sample, rounded up.
+        const std::uint64_t rank = (std::uint64_t{ count } * parts + whole - 1) / whole;
+        std::uint64_t seen{ 0 };
+        for (std::uint32_t i = 0; i < BUCKETS; i++) {
+            seen += histogram[i];
+            if (seen >= rank && seen > 0) {
+                const auto value = bucket_max(i);
+                return value < max ? value : max;
+            }
+        }
+        return max;
+    }
+};
+
+using jitter_histogram = log_linear_histogram<>;
+
+extern "C" {
+/** Wakeup lateness of timer scheduled co-routines in nanoseconds, not mangled so a debugger can print it by name. */
+inline jitter_histogram wakeup_jitter_log{};
+}
+
+/** Record wakeup lateness in wakeup_jitter_log and the trace.
+ */
+class jitter_log_manager {
+  public:
+    /** Called when a co-routine is resumed.
+        @param lateness Resume time after the scheduled time, limited to 0 to 2^32-1 ns.
+     */
+    template<class DURATION>
+    static void wakeup(DURATION lateness) noexcept {
+        const auto ns = std::chrono::duration_cast<std::chrono::nanoseconds>(lateness).count();
+        const std::uint32_t lateness_ns = (ns < 0) ? 0 : (ns > 0xFFFFFFFF) ? 0xFFFFFFFF
+                                                                              : static_cast<std::uint32_t>(ns);
+        wakeup_jitter_log.add(lateness_ns);
+        TRACE_EVENT(wake_jitter, lateness_ns);
+    }
+
+    /** Clear all results.
+     */
+    static void reset() noexcept {
+        wakeup_jitter_log = jitter_histogram{};
+    }
+
+#if defined(HOST_EMULATION)
+    /** Print the results.
+     */
+    static void print(FILE* out) {
+        const auto& log = wakeup_jitter_log;
+        fprintf(out, "wakeup jitter ns: count=%u min=%u p50=%u p90=%u p99=%u p99.9=%u max=%u\n",
+                log.count, log.min, log.percentile(50), log.percentile(90), log.percentile(99),
+                log.percentile(999, 1000), log.max);
+    }
+#endif
+};
+
+#if defined(ENABLE_WAKEUP_JITTER)
+
+#define WAKEUP_JITTER(lateness) \
+    jitter_log_manager::wakeup(lateness)
+
+#else
+
+#define WAKEUP_JITTER(lateness)
+
+#endif
+
+#endif// JITTER_HPP
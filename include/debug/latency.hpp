@@ -0,0 +1,198 @@
+/*
+   Interrupt to co-routine latency measurement.
+
+   Timestamps are taken at ISR entry, when a scheduler dispatches a
+   co-routine and when the co-routine resumes. The intervals from ISR
+   entry are aggregated per interrupt cause.
+
+   The hooks compile to nothing unless ENABLE_LATENCY_TRACE is defined.
+
+   SPDX-License-Identifier: Unlicense
+
+   https://five-embeddev.com/
+
+*/
+
+#ifndef LATENCY_HPP
+#define LATENCY_HPP
+
+#include <cstdint>
+#include <bit>
+
+#if defined(HOST_EMULATION)
+#include <chrono>
+#include <cstdio>
+#else
+#include "../riscv/riscv-csr.hpp"
+#endif
+
+#ifndef LATENCY_CAUSE_COUNT
+/** Number of interrupt causes to record, covers the machine mode interrupts. */
+#define LATENCY_CAUSE_COUNT 12
+#endif
+
+#ifndef LATENCY_HISTOGRAM_BUCKETS
+/** Number of log2 histogram buckets, the last bucket holds all larger values. */
+#define LATENCY_HISTOGRAM_BUCKETS 12
+#endif
+
+/** Timestamps are in CPU cycles (mcycle) on target and nanoseconds on the host. */
+using latency_timestamp_t = std::uint32_t;
+
+/** Min/average/max and log2 histogram of a latency interval.
+ */
+struct latency_stats {
+    std::uint32_t count;
+    latency_timestamp_t min;
+    latency_timestamp_t max;
+    std::uint64_t sum;
+    //! Bucket i counts values with bit width i, i.e. [2^(i-1), 2^i)
+    std::uint32_t histogram[LATENCY_HISTOGRAM_BUCKETS];
+
+    /** Add a sample.
+     */
+    void add(latency_timestamp_t value) noexcept {
+        if (count == 0 || value < min) {
+            min = value;
+        }
+        if (value > max) {
+            max = value;
+        }
+        count++;
+        sum += value;
+        auto bucket = static_cast<unsigned int>(std::bit_width(value));
+        if (bucket >= LATENCY_HISTOGRAM_BUCKETS) {
+            bucket = LATENCY_HISTOGRAM_BUCKETS - 1;
+        }
+        histogram[bucket]++;
+    }
+
+    /** Average of all samples, 0 if there are no samples.
+     */
+    latency_timestamp_t average() const noexcept {
+        return count ? static_cast<latency_timestamp_t>(sum / count) : 0;
+    }
+};
+
+/** Latency from ISR entry, per interrupt cause.
+ */
+struct latency_cause_stats {
+    //! ISR entry to the scheduler dispatching the co-routine.
+    latency_stats dispatch;
+    //! ISR entry to the co-routine running.
+    latency_stats resume;
+};
+
+extern "C" {
+/** Results per cause, a C symbol so GDB can print it by name (make latency_qemu). */
+inline latency_cause_stats latency_log[LATENCY_CAUSE_COUNT]{};
+}
+
+/** Record timestamps and aggregate them into latency_log.
+
+    Only a single ISR is tracked at a time. The first dispatch and
+    the first co-routine resume after ISR entry are attributed to
+    that interrupt cause.
+ */
+class latency_log_manager {
+  public:
+    static latency_timestamp_t now() noexcept {
+#if defined(HOST_EMULATION)
+        return static_cast<latency_timestamp_t>(
+            std::chrono::duration_cast<std::chrono::nanoseconds>(
+                std::chrono::steady_clock::now().time_since_epoch())
+                .count());
+#else
+        return static_cast<latency_timestamp_t>(riscv::csrs.mcycle.read());
+#endif
+    }
+
+    /** Called at ISR entry.
+        @param cause The interrupt cause (mcause), the interrupt bit is ignored.
+     */
+    static void isr_entry(std::uintptr_t cause) noexcept {
+        isr_timestamp_ = now();
+        isr_cause_ = static_cast<std::uint32_t>(cause & 0xFF);
+        dispatch_pending_ = isr_cause_ < LATENCY_CAUSE_COUNT;
+        resume_pending_ = dispatch_pending_;
+    }
+
+    /** Called when a scheduler is about to resume a co-routine.
+     */
+    static void dispatch() noexcept {
+        if (dispatch_pending_) {
+            dispatch_pending_ = false;
+            latency_log[isr_cause_].dispatch.add(now() - isr_timestamp_);
+        }
+    }
+
+    /** Called when a co-routine resumes.
+     */
+    static void resume() noexcept {
+        if (resume_pending_) {
+            resume_pending_ = false;
+            latency_log[isr_cause_].resume.add(now() - isr_timestamp_);
+        }
+    }
+
+    /** Clear all results.
+     */
+    static void reset() noexcept {
+        for (auto& entry : latency_log) {
+            entry = latency_cause_stats{};
+        }
+        dispatch_pending_ = false;
+        resume_pending_ = false;
+    }
+
+#if defined(HOST_EMULATION)
+    /** Print the results.
+     */
+    static void print(FILE* out) {
+        for (unsigned int cause = 0; cause < LATENCY_CAUSE_COUNT; cause++) {
+            const auto& entry = latency_log[cause];
+            if (entry.dispatch.count == 0 && entry.resume.count == 0) {
+                continue;
+            }
+            print_stats(out, cause, "dispatch", entry.dispatch);
+            print_stats(out, cause, "resume", entry.resume);
+        }
+    }
+#endif
+
+  private:
+#if defined(HOST_EMULATION)
+    static void print_stats(FILE* out, unsigned int cause, const char* label, const latency_stats& stats) {
+        fprintf(out, "cause %u %s: count=%u min=%u avg=%u max=%u histogram=",
+                cause, label, stats.count, stats.min, stats.average(), stats.max);
+        for (auto bucket : stats.histogram) {
+            fprintf(out, " %u", bucket);
+        }
+        fprintf(out, "\n");
+    }
+#endif
+
+    inline static volatile latency_timestamp_t isr_timestamp_{ 0 };
+    inline static volatile std::uint32_t isr_cause_{ 0 };
+    inline static volatile bool dispatch_pending_{ false };
+    inline static volatile bool resume_pending_{ false };
+};
+
+#if defined(ENABLE_LATENCY_TRACE)
+
+#define LATENCY_ISR_ENTRY(cause) \
+    latency_log_manager::isr_entry(cause)
+#define LATENCY_DISPATCH() \
+    latency_log_manager::dispatch()
+#define LATENCY_RESUME() \
+    latency_log_manager::resume()
+
+#else
+
+#define LATENCY_ISR_ENTRY(cause)
+#define LATENCY_DISPATCH()
+#define LATENCY_RESUME()
+
+#endif
+
+#endif// LATENCY_HPP
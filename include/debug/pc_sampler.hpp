@@ -0,0 +1,184 @@
+/*
+   Statistical PC sampling profiler.
+
+   A periodic timer interrupt records the interrupted program counter
+   (mepc) in a hash table of PC and sample count. pc_profile.py stops
+   Spike at pc_sample_done(), reads the table and maps it to symbols.
+
+   The hooks compile to nothing unless ENABLE_PC_SAMPLING is defined,
+   and on the host, as there is no interrupted PC to sample.
+
+   SPDX-License-Identifier: Unlicense
+
+   https://five-embeddev.com/
+
+*/
+
+#ifndef PC_SAMPLER_HPP
+#define PC_SAMPLER_HPP
+
+#include <cstdint>
+#include <cstddef>
+#include <bit>
+#include <chrono>
+
+#if !defined(HOST_EMULATION)
+#include "../riscv/riscv-csr.hpp"
+#endif
+
+#ifndef PC_SAMPLE_ENTRIES
+/** Number of distinct PCs recorded, must be a power of 2. */
+#define PC_SAMPLE_ENTRIES 256
+#endif
+
+#ifndef PC_SAMPLE_PROBES
+/** Entries searched for a PC before the sample is dropped. */
+#define PC_SAMPLE_PROBES 8
+#endif
+
+#ifndef PC_SAMPLE_PERIOD_US
+/** Sampling period of PC_SAMPLE_TIMER(). */
+#define PC_SAMPLE_PERIOD_US 100
+#endif
+
+#ifndef PC_SAMPLE_LIMIT
+/** pc_sample_done() is called when this many samples have been taken. */
+#define PC_SAMPLE_LIMIT 1000
+#endif
+
+/** Sample count of one PC.
+ */
+struct pc_sample_entry {
+    //! Sampled PC, 0 for an unused entry.
+    std::uintptr_t pc;
+    std::uintptr_t count;
+};
+
+/** Sample table in memory, read from a simulator and decoded by pc_profile.py.
+    8 byte aligned, Spike reads memory as 64 bit words.
+ */
+struct alignas(8) pc_sample_table {
+    static constexpr std::uint32_t MAGIC = 0x31435053;// "SPC1"
+
+    std::uint32_t magic{ MAGIC };
+    std::uint32_t pc_bytes{ sizeof(std::uintptr_t) };
+    std::uint32_t entries{ PC_SAMPLE_ENTRIES };
+    //! Total samples, including dropped samples.
+    std::uint32_t samples{ 0 };
+    //! Samples not recorded as the table was full.
+    std::uint32_t dropped{ 0 };
+    std::uint32_t reserved{ 0 };
+    pc_sample_entry histogram[PC_SAMPLE_ENTRIES]{};
+};
+
+extern "C" {
+/** The samples, the runner finds the table by its unmangled name in the ELF symbol table. */
+inline pc_sample_table pc_sample_log{};
+
+/** Called once PC_SAMPLE_LIMIT samples are taken, pc_profile.py stops the simulator here. */
+[[gnu::noinline]] inline void pc_sample_done(void) {
+    __asm__ volatile("" ::: "memory");
+}
+}
+
+/** Add samples to pc_sample_log.
+ */
+class pc_sampler {
+    static_assert((PC_SAMPLE_ENTRIES & (PC_SAMPLE_ENTRIES - 1)) == 0, "PC_SAMPLE_ENTRIES must be a power of 2");
+    static constexpr unsigned int INDEX_BITS = std::bit_width(static_cast<unsigned int>(PC_SAMPLE_ENTRIES)) - 1;
+    static constexpr std::uint32_t INDEX_MASK = PC_SAMPLE_ENTRIES - 1;
+
+  public:
+    /** Record a sample, called from the interrupt handler.
+        @param pc The interrupted PC (mepc).
+     */
+    static void sample(std::uintptr_t pc) noexcept {
+        pc_sample_log.samples++;
+        add(pc);
+        if (pc_sample_log.samples == PC_SAMPLE_LIMIT) {
+            pc_sample_done();
+        }
+    }
+
+    /** Samples recorded for a PC.
+     */
+    static std::uintptr_t count(std::uintptr_t pc) noexcept {
+        for (const auto& entry : pc_sample_log.histogram) {
+            if (entry.count != 0 && entry.pc == pc) {
+                return entry.count;
+            }
+        }
+        return 0;
+    }
+
+    /** Clear all samples.
+     */
+    static void reset() noexcept {
+        pc_sample_log = pc_sample_table{};
+    }
+
+  private:
+    /** Count the PC in the histogram, or as dropped if the probed entries are used.
+     */
+    static void add(std::uintptr_t pc) noexcept {
+        // Multiplicative hash, instructions are at least 2 byte aligned.
+        const std::uint32_t hash = static_cast<std::uint32_t>(pc >> 1) * 2654435761u;
+        std::uint32_t index = (INDEX_BITS > 0) ? (hash >> (32 - INDEX_BITS)) : 0;
+        for (unsigned int probe = 0; probe < PC_SAMPLE_PROBES; probe++) {
+            auto& entry = pc_sample_log.histogram[index];
+            if (entry.pc == pc || entry.count == 0) {
+                entry.pc = pc;
+                entry.count++;
+                return;
+            }
+            index = (index + 1) & INDEX_MASK;
+        }
+        pc_sample_log.dropped++;
+    }
+};
+
+/** Longest sleep of the idle policy (mtimer_idle) while sampling, 0 when not sampling.
+    The idle policy shares mtimecmp with PC_SAMPLE_TIMER(), it wakes at the earlier of
+    the next scheduled wakeup and the next sample.
+ */
+inline constexpr std::chrono::microseconds pc_sample_max_sleep{
+#if defined(ENABLE_PC_SAMPLING) && !defined(HOST_EMULATION)
+    PC_SAMPLE_PERIOD_US
+#else
+    0
+#endif
+};
+
+/** Longest sleep of the idle policy when sampling every sample_period.
+    @param max_sleep      Longest sleep without sampling, 0 for no limit.
+    @param sample_period  Sampling period, 0 when not sampling.
+ */
+constexpr std::chrono::microseconds pc_sample_sleep(std::chrono::microseconds max_sleep,
+                                                    std::chrono::microseconds sample_period) noexcept {
+    if ((sample_period.count() != 0)
+        && ((max_sleep.count() == 0) || (max_sleep > sample_period))) {
+        return sample_period;
+    }
+    return max_sleep;
+}
+
+#if defined(ENABLE_PC_SAMPLING) && !defined(HOST_EMULATION)
+
+/** Sample mepc from the machine timer interrupt handler and interrupt again after PC_SAMPLE_PERIOD_US.
+    The idle policy (e.g. mtimer_idle) sets the earlier of the next scheduled wakeup and
+    pc_sample_max_sleep before it waits.
+ */
+#define PC_SAMPLE_TIMER(mtimer)                                               \
+    do {                                                                      \
+        pc_sampler::sample(riscv::csrs.mepc.read());                          \
+        (mtimer).set_time_cmp(std::chrono::microseconds(PC_SAMPLE_PERIOD_US)); \
+        riscv::csrs.mie.mti.set();                                            \
+    } while (0)
+
+#else
+
+#define PC_SAMPLE_TIMER(mtimer)
+
+#endif
+
+#endif// PC_SAMPLER_HPP
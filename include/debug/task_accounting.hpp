@@ -0,0 +1,258 @@
+/*
+   Per co-routine CPU time accounting.
+
+   The schedulers read the cycle (mcycle) and instruction (minstret)
+   counters around each resume, and attribute the run time, instructions
+   and resume count to the co-routine, keyed by its frame address.
+   Time of co-routines resumed while another co-routine runs (e.g. an
+   execution level or ISR scheduler) is only attributed to the inner
+   co-routine. Time in interrupt handlers is attributed to the co-routine
+   that was interrupted.
+
+   The hooks compile to nothing unless ENABLE_TASK_ACCOUNTING is defined.
+
+   SPDX-License-Identifier: Unlicense
+
+   https://five-embeddev.com/
+
+*/
+
+#ifndef TASK_ACCOUNTING_HPP
+#define TASK_ACCOUNTING_HPP
+
+#include <coroutine>
+#include <cstdint>
+#include <cstddef>
+
+#if defined(HOST_EMULATION)
+#include <chrono>
+#include <cstdio>
+#else
+#include "../riscv/riscv-csr.hpp"
+#endif
+
+#ifndef TASK_ACCOUNT_ENTRIES
+/** Number of co-routines to account, the last entry holds all co-routines that did not fit. */
+#define TASK_ACCOUNT_ENTRIES 16
+#endif
+
+#if defined(HOST_EMULATION)
+// Each emulated hart thread has its own accounts.
+#define TASK_ACCOUNT_STORAGE thread_local
+#else
+// NOTE - The accounts are shared by all harts, only account on one hart.
+#define TASK_ACCOUNT_STORAGE
+#endif
+
+/** Counters of one co-routine.
+ */
+struct task_account {
+    //! Co-routine frame address, nullptr for an unused entry.
+    const void* key;
+    //! Registered name, or nullptr.
+    const char* name;
+    //! CPU cycles (mcycle) on target, nanoseconds on the host.
+    std::uint64_t cycles;
+    //! Instructions retired (minstret) on target, not counted on the host.
+    std::uint64_t instret;
+    std::uint32_t resumes;
+};
+
+/** Counter values at the start of a resume.
+ */
+struct task_account_start {
+    std::uint32_t cycles;
+    std::uint32_t instret;
+    std::uint32_t nested_cycles;
+    std::uint32_t nested_instret;
+};
+
+/** Attribute the counters to co-routines.
+ */
+class task_account_manager {
+  public:
+    /** Called before a co-routine is resumed.
+     */
+    static task_account_start start() noexcept {
+        const auto mstatus = disable();
+        const task_account_start now{ cycles(), instret(), nested_cycles_, nested_instret_ };
+        restore(mstatus);
+        return now;
+    }
+
+    /** Called after the co-routine suspended or completed.
+        @param begin  Value returned by start().
+        @param key    Co-routine frame address.
+     */
+    static void stop(const task_account_start& begin, const void* key) noexcept {
+        const auto mstatus = disable();
+        const std::uint32_t elapsed_cycles = cycles() - begin.cycles;
+        const std::uint32_t elapsed_instret = instret() - begin.instret;
+        auto& entry = find(key);
+        // Exclude co-routines resumed inside this one, they have their own entries.
+        entry.cycles += elapsed_cycles - (nested_cycles_ - begin.nested_cycles);
+        entry.instret += elapsed_instret - (nested_instret_ - begin.nested_instret);
+        entry.resumes++;
+        nested_cycles_ = begin.nested_cycles + elapsed_cycles;
+        nested_instret_ = begin.nested_instret + elapsed_instret;
+        restore(mstatus);
+    }
+
+    /** Name a co-routine in the accounts.
+     */
+    static void name(const void* key, const char* label) noexcept {
+        find(key).name = label;
+    }
+
+    /** All accounts, unused entries have a nullptr key.
+     */
+    static const task_account (&accounts(void) noexcept)[TASK_ACCOUNT_ENTRIES] {
+        return accounts_;
+    }
+
+    /** The co-routines that used the most cycles.
+        @param top   Filled with the accounts in order of decreasing cycles.
+        @retval      Number of accounts in top.
+     */
+    template<std::size_t N>
+    static std::size_t top(const task_account* (&top)[N]) noexcept {
+        std::size_t count{ 0 };
+        for (const auto& entry : accounts_) {
+            if (entry.resumes == 0) {
+                continue;
+            }
+            // Insertion into the sorted list, dropping the smallest.
+            std::size_t i = (count < N) ? count++ : N;
+            while (i > 0 && top[i - 1]->cycles < entry.cycles) {
+                if (i < N) {
+                    top[i] = top[i - 1];
+                }
+                i--;
+            }
+            if (i < N) {
+                top[i] = &entry;
+            }
+        }
+        return count;
+    }
+
+    /** Clear all accounts.
+     */
+    static void reset() noexcept {
+        for (auto& entry : accounts_) {
+            entry = task_account{};
+        }
+    }
+
+#if defined(HOST_EMULATION)
+    /** Print the co-routines that used the most cycles.
+     */
+    template<std::size_t N = 10>
+    static void print(FILE* out) {
+        const task_account* entries[N];
+        const auto count = top(entries);
+        for (std::size_t i = 0; i < count; i++) {
+            const auto& entry = *entries[i];
+            fprintf(out, "task %-16s %p: resumes=%u cycles=%llu instret=%llu\n",
+                    entry.name ? entry.name : "", entry.key, entry.resumes,
+                    static_cast<unsigned long long>(entry.cycles),
+                    static_cast<unsigned long long>(entry.instret));
+        }
+    }
+#endif
+
+  private:
+    static std::uint32_t cycles() noexcept {
+#if defined(HOST_EMULATION)
+        return static_cast<std::uint32_t>(
+            std::chrono::duration_cast<std::chrono::nanoseconds>(
+                std::chrono::steady_clock::now().time_since_epoch())
+                .count());
+#else
+        return static_cast<std::uint32_t>(riscv::csrs.mcycle.read());
+#endif
+    }
+
+    static std::uint32_t instret() noexcept {
+#if defined(HOST_EMULATION)
+        return 0;
+#else
+        return static_cast<std::uint32_t>(riscv::csrs.minstret.read());
+#endif
+    }
+
+    // An ISR resuming a co-routine must not update the nested counters while they are used.
+    static std::uintptr_t disable() noexcept {
+#if defined(HOST_EMULATION)
+        return 0;
+#else
+        return riscv::csrs.mstatus.read_clr_bits_const<riscv::csr::mstatus_data::mie::BIT_MASK>();
+#endif
+    }
+
+    static void restore([[maybe_unused]] std::uintptr_t mstatus) noexcept {
+#if !defined(HOST_EMULATION)
+        riscv::csrs.mstatus.set(mstatus & riscv::csr::mstatus_data::mie::BIT_MASK);
+#endif
+    }
+
+    static task_account& find(const void* key) noexcept {
+        for (std::size_t i = 0; i < TASK_ACCOUNT_ENTRIES - 1; i++) {
+            auto& entry = accounts_[i];
+            if (entry.key == key) {
+                return entry;
+            }
+            if (entry.key == nullptr) {
+                entry.key = key;
+                return entry;
+            }
+        }
+        return accounts_[TASK_ACCOUNT_ENTRIES - 1];
+    }
+
+    inline static TASK_ACCOUNT_STORAGE task_account accounts_[TASK_ACCOUNT_ENTRIES]{};
+    //! Counters attributed to any co-routine, used to exclude nested co-routines.
+    inline static TASK_ACCOUNT_STORAGE std::uint32_t nested_cycles_{ 0 };
+    inline static TASK_ACCOUNT_STORAGE std::uint32_t nested_instret_{ 0 };
+};
+
+/** Name the calling co-routine in the accounts, without suspending.
+
+    co_await task_account_name{ "blink" };
+
+    Without ENABLE_TASK_ACCOUNTING it is ready immediately and the accounts are not linked.
+ */
+struct task_account_name {
+    const char* label;
+
+    constexpr bool await_ready() const noexcept {
+#if defined(ENABLE_TASK_ACCOUNTING)
+        return false;
+#else
+        return true;
+#endif
+    }
+    bool await_suspend([[maybe_unused]] std::coroutine_handle<> handle) const noexcept {
+#if defined(ENABLE_TASK_ACCOUNTING)
+        task_account_manager::name(handle.address(), label);
+#endif
+        return false;
+    }
+    constexpr void await_resume() const noexcept {}
+};
+
+#if defined(ENABLE_TASK_ACCOUNTING)
+
+#define TASK_ACCOUNT_RESUME() \
+    const auto task_account_begin = task_account_manager::start()
+#define TASK_ACCOUNT_SUSPEND(handle) \
+    task_account_manager::stop(task_account_begin, (handle).address())
+
+#else
+
+#define TASK_ACCOUNT_RESUME()
+#define TASK_ACCOUNT_SUSPEND(handle)
+
+#endif
+
+#endif// TASK_ACCOUNTING_HPP
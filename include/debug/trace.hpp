@@ -1,5 +1,23 @@
 /*
-   Quick and dirty tracer.
+   Binary event tracer.
+
+   Each event is encoded in a byte ring buffer as:
+
+     event id (1 byte), delta timestamp (LEB128), payload (LEB128)
+
+   The first event in each quarter of the ring is preceded by a sync
+   event holding the absolute timestamp, and its position is saved in
+   the log header. A decoder starts at the oldest sync that has not
+   been overwritten, see trace_to_chrome.py.
+
+   Events are grouped in categories. TRACE_CATEGORIES is the mask of
+   categories recorded. It is a build setting (CMake -DTRACE_CATEGORIES),
+   not a per file option: the trace macros are expanded in inline and
+   template functions, which must be the same in every translation unit.
+
+   Defining ENABLE_TRACE records all categories. Events of a disabled
+   category are in a discarded if constexpr branch, so their payload is
+   not evaluated and no code or data is emitted.
 
    SPDX-License-Identifier: Unlicense
 
@@ -11,66 +29,267 @@
 #ifndef TRACE_HPP
 #define TRACE_HPP
 
-#define ENABLE_TRACE
+#include <cstdint>
+#include <cstddef>
+#include <type_traits>
+
+#include "latency.hpp"
+
+/** Trace categories, bits of TRACE_CATEGORIES. */
+#define TRACE_CATEGORY_SCHEDULER 0x1u// Scheduler insert and wake, main loop pending.
+#define TRACE_CATEGORY_ISR 0x2u      // Interrupt enter and exit.
+#define TRACE_CATEGORY_TASK 0x4u     // Co-routine resume and suspend.
+#define TRACE_CATEGORY_TIMER 0x8u    // Main loop timestamp, next wake delay and wakeup jitter.
+#define TRACE_CATEGORY_ALL 0xFu
+
+#ifndef TRACE_CATEGORIES
+#if defined(ENABLE_TRACE)
+#define TRACE_CATEGORIES TRACE_CATEGORY_ALL
+#else
+/** Categories to record, none by default. */
+#define TRACE_CATEGORIES 0u
+#endif
+#endif
+
+#if defined(HOST_EMULATION)
+#include <cstdio>
+#endif
 
-#ifndef ENABLE_TRACE
+#ifndef TRACE_BUFFER_SIZE
+/** Size of the trace ring buffer in bytes, must be a power of 2. */
+#define TRACE_BUFFER_SIZE 1024
+#endif
 
-#define TRACE_TIMESTAMP(timestamp)
-#define TRACE_VALUE(label, value)
-#define TRACE_VALUE_FLAG(label, mask)
+#ifndef TRACE_TICKS_PER_US
+#if defined(HOST_EMULATION)
+/** Timestamp ticks per microsecond, nanoseconds on the host. */
+#define TRACE_TICKS_PER_US 1000
+#else
+/** Timestamp ticks per microsecond, mcycle on target so this is the core clock in MHz. */
+#define TRACE_TICKS_PER_US 1
+#endif
+#endif
 
+#if defined(HOST_EMULATION)
+// Each emulated hart thread has its own log.
+#define TRACE_LOG_STORAGE thread_local
 #else
+// NOTE - The log is shared by all harts, only trace from one hart.
+#define TRACE_LOG_STORAGE
+#endif
 
-#include <stdint.h>
+using trace_timestamp_t = std::uint32_t;
 
-#define TRACE_ENTRY_COUNT_POW2 128
+/** Event ids, keep in sync with EVENTS in trace_to_chrome.py */
+enum class trace_event : std::uint8_t {
+    sync = 0,          // Absolute timestamp, no delta.
+    timestamp,         // TRACE_TIMESTAMP()
+    coro_pending,      // Main loop has pending co-routines.
+    next_wake_delay,   // Main loop delay to the next wakeup.
+    scheduler_insert,  // Co-routine handle inserted in a scheduler.
+    scheduler_wake,    // Scheduler, that is about to resume a co-routine.
+    coro_resume,       // Co-routine handle resumed.
+    coro_suspend,      // Co-routine handle suspended or completed.
+    isr_enter,         // Interrupt cause (mcause).
+    isr_exit,          // Interrupt cause (mcause).
+    wake_jitter,       // Timer wakeup lateness in nanoseconds.
+};
 
-using trace_timestamp_t = uint32_t;
+/** Category of an event, see TRACE_CATEGORIES.
+ */
+constexpr unsigned int trace_category(trace_event event) noexcept {
+    switch (event) {
+    case trace_event::scheduler_insert:
+    case trace_event::scheduler_wake:
+    case trace_event::coro_pending:
+        return TRACE_CATEGORY_SCHEDULER;
+    case trace_event::isr_enter:
+    case trace_event::isr_exit:
+        return TRACE_CATEGORY_ISR;
+    case trace_event::coro_resume:
+    case trace_event::coro_suspend:
+        return TRACE_CATEGORY_TASK;
+    case trace_event::timestamp:
+    case trace_event::next_wake_delay:
+    case trace_event::wake_jitter:
+        return TRACE_CATEGORY_TIMER;
+    default:
+        return 0;
+    }
+}
 
-struct trace_log_entry {
-    uint32_t index;
-    trace_timestamp_t timestamp;
-    trace_timestamp_t delta_timestamp;
-    bool coro_pending;
-    trace_timestamp_t next_wake_delay;
-    uint16_t scheduler_update_i;
-    uint16_t scheduler_update_r;
+/** Trace log in memory, dumped from a debugger or simulator and decoded on the host.
+ */
+struct trace_buffer {
+    static constexpr std::uint32_t MAGIC = 0x31435254;// "TRC1"
+    static constexpr std::uint32_t SYNC_COUNT = 4;
+
+    std::uint32_t magic{ MAGIC };
+    std::uint32_t size{ TRACE_BUFFER_SIZE };
+    std::uint32_t ticks_per_us{ TRACE_TICKS_PER_US };
+    //! Total bytes written, the write position is head % size.
+    std::uint32_t head{ 0 };
+    //! Position (in bytes written) of the last sync event in each quarter of the buffer.
+    std::uint32_t sync[SYNC_COUNT]{};
+    std::uint8_t data[TRACE_BUFFER_SIZE]{};
 };
 
 class trace_log_manager {
-    static constexpr uint32_t COUNT_MASK = TRACE_ENTRY_COUNT_POW2 - 1;
+    static_assert((TRACE_BUFFER_SIZE & (TRACE_BUFFER_SIZE - 1)) == 0, "TRACE_BUFFER_SIZE must be a power of 2");
+    static constexpr std::uint32_t INDEX_MASK = TRACE_BUFFER_SIZE - 1;
+    static constexpr std::uint32_t SYNC_SPACING = TRACE_BUFFER_SIZE / trace_buffer::SYNC_COUNT;
+    //! Event id, two 64 bit LEB128 values.
+    static constexpr std::size_t MAX_RECORD = 1 + 10 + 10;
 
   public:
-    static void next_entry(trace_timestamp_t t) {
-        auto prev_timestamp = records[_index].timestamp;
-        _index = (_index + 1) & COUNT_MASK;
-        std::fill((uint8_t*)&records[_index],// cppcheck-suppress mismatchingContainers
-                  (uint8_t*)&records[_index + 1],
-                  0U);
-        records[_index].index = _index;
-        records[_index].timestamp = t;
-        records[_index].delta_timestamp = t - prev_timestamp;
+    /** Convert a payload to the encoded type.
+     */
+    template<typename T>
+    static std::uint64_t payload(T value) noexcept {
+        if constexpr (std::is_pointer_v<T>) {
+            return reinterpret_cast<std::uintptr_t>(value);
+        }
+        else {
+            return static_cast<std::uint64_t>(value);
+        }
     }
-    static trace_log_entry& get_entry(void) {
-        return records[_index];
+
+    /** Append an event to the log.
+     */
+    static void record(trace_event event, std::uint64_t value) noexcept {
+#if !defined(HOST_EMULATION)
+        // An ISR must not write between the header update and the event data.
+        const auto mstatus = riscv::csrs.mstatus.read_clr_bits_const<riscv::csr::mstatus_data::mie::BIT_MASK>();
+#endif
+        const trace_timestamp_t t = latency_log_manager::now();
+        if (log_.head == 0 || (log_.head / SYNC_SPACING) != sync_spacing_) {
+            sync_spacing_ = log_.head / SYNC_SPACING;
+            log_.sync[sync_spacing_ % trace_buffer::SYNC_COUNT] = log_.head;
+            write(trace_event::sync, 0, t);
+            last_ = t;
+        }
+        write(event, t - last_, value);
+        last_ = t;
+#if !defined(HOST_EMULATION)
+        riscv::csrs.mstatus.set(mstatus & riscv::csr::mstatus_data::mie::BIT_MASK);
+#endif
+    }
+
+    /** The log, to be dumped for decoding.
+     */
+    static const trace_buffer& log(void) noexcept {
+        return log_;
+    }
+
+    /** Clear the log.
+     */
+    static void reset(void) noexcept {
+        log_ = trace_buffer{};
+        last_ = 0;
+        sync_spacing_ = 0;
     }
 
+    /** Decode the events in a log, oldest first.
+        @param log    The log to decode.
+        @param visit  Called as visit(trace_event, timestamp, payload) for each event, not for sync.
+     */
+    template<class VISIT>
+    static void decode(const trace_buffer& log, VISIT visit) {
+        const std::uint32_t oldest = (log.head > log.size) ? (log.head - log.size) : 0;
+        bool found{ false };
+        std::uint32_t pos{ 0 };
+        for (auto sync : log.sync) {
+            if (sync >= oldest && sync < log.head && (!found || sync < pos)) {
+                pos = sync;
+                found = true;
+            }
+        }
+        if (!found) {
+            return;
+        }
+        std::uint64_t t{ 0 };
+        while (pos < log.head) {
+            const auto event = static_cast<trace_event>(log.data[pos++ & (log.size - 1)]);
+            const auto delta = read_leb(log, pos);
+            const auto value = read_leb(log, pos);
+            if (event == trace_event::sync) {
+                t = value;
+                continue;
+            }
+            t += delta;
+            visit(event, t, value);
+        }
+    }
+
+#if defined(HOST_EMULATION)
+    /** Write the log for trace_to_chrome.py.
+     */
+    static void dump(FILE* out) {
+        fwrite(&log_, sizeof(log_), 1, out);
+    }
+#endif
+
   private:
-    inline static trace_log_entry records[TRACE_ENTRY_COUNT_POW2]{};
-    inline static uint32_t _index{ COUNT_MASK };
+    static void write(trace_event event, std::uint64_t delta, std::uint64_t value) noexcept {
+        std::uint8_t record[MAX_RECORD];
+        std::size_t length{ 0 };
+        record[length++] = static_cast<std::uint8_t>(event);
+        length = write_leb(record, length, delta);
+        length = write_leb(record, length, value);
+        for (std::size_t i = 0; i < length; i++) {
+            log_.data[(log_.head + i) & INDEX_MASK] = record[i];
+        }
+        log_.head += static_cast<std::uint32_t>(length);
+    }
+
+    static std::size_t write_leb(std::uint8_t* record, std::size_t length, std::uint64_t value) noexcept {
+        while (value >= 0x80) {
+            record[length++] = static_cast<std::uint8_t>(value | 0x80);
+            value >>= 7;
+        }
+        record[length++] = static_cast<std::uint8_t>(value);
+        return length;
+    }
+
+    static std::uint64_t read_leb(const trace_buffer& log, std::uint32_t& pos) noexcept {
+        std::uint64_t value{ 0 };
+        unsigned int shift{ 0 };
+        std::uint8_t byte{ 0 };
+        do {
+            byte = log.data[pos++ & (log.size - 1)];
+            value |= std::uint64_t{ byte & 0x7Fu } << shift;
+            shift += 7;
+        } while ((byte & 0x80) && shift < 64);
+        return value;
+    }
+
+    inline static TRACE_LOG_STORAGE trace_buffer log_{};
+    inline static TRACE_LOG_STORAGE trace_timestamp_t last_{ 0 };
+    inline static TRACE_LOG_STORAGE std::uint32_t sync_spacing_{ 0 };
 };
 
 
-#define TRACE_TIMESTAMP(timestamp) \
-    trace_log_manager::next_entry(timestamp)
+/** Record EVENT if its category is in the mask CATEGORIES. */
+#define TRACE_RECORD_IF(CATEGORIES, EVENT, VALUE)                                         \
+    do {                                                                                  \
+        if constexpr (((CATEGORIES) & trace_category(EVENT)) != 0) {                      \
+            trace_log_manager::record(EVENT, trace_log_manager::payload(VALUE));          \
+        }                                                                                 \
+    } while (0)
+
+#define TRACE_RECORD(EVENT, VALUE) \
+    TRACE_RECORD_IF(TRACE_CATEGORIES, EVENT, VALUE)
+
+#define TRACE_TIMESTAMP(VALUE) \
+    TRACE_RECORD(trace_event::timestamp, VALUE)
 
 #define TRACE_VALUE(label, VALUE) \
-    trace_log_manager::get_entry().label = (VALUE)
+    TRACE_RECORD(trace_event::label, VALUE)
 
 #define TRACE_VALUE_FLAG(label, VALUE) \
-    trace_log_manager::get_entry().label |= (VALUE)
-
-#endif
+    TRACE_RECORD(trace_event::label, VALUE)
 
+#define TRACE_EVENT(label, VALUE) \
+    TRACE_RECORD(trace_event::label, VALUE)
 
 #endif
@@ -14,6 +14,15 @@
 #include "coro/scheduler.hpp"
 #include "coro/nop_task.hpp"
 #include "coro/awaitable_timer.hpp"
+#include "coro/scheduler_deadline.hpp"
+#include "coro/awaitable_deadline.hpp"
+#include "coro/scheduler_aging.hpp"
 #include "coro/awaitable_unordered.hpp"
+#include "coro/awaitable_event_group.hpp"
+#include "coro/deferred_queue.hpp"
+#include "coro/execution_levels.hpp"
+#include "coro/smp_executor.hpp"
+#include "coro/per_hart.hpp"
+#include "coro/executor.hpp"
 
 #endif// EMBEDDEV_CORO_H_
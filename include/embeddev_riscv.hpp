@@ -16,6 +16,9 @@
 #include "riscv/riscv-interrupts.hpp"
 #include "host/riscv-irq.hpp"
 #include "host/timer.hpp"
+#include "host/msip.hpp"
+#include "host/smp.hpp"
+#include "host/pmu.hpp"
 #else
 // RISC-V CSR definitions and access classes
 // Download: wget https://raw.githubusercontent.com/five-embeddev/riscv-csr-access/master/include/riscv-csr.hpp
@@ -25,10 +28,16 @@
 #include "riscv/riscv-irq.hpp"
 #include "riscv/timer.hpp"
 #include "riscv/scheduler-timer-mtimer.hpp"
+#include "riscv/msip.hpp"
+#include "riscv/smp.hpp"
+#include "riscv/pmu.hpp"
 #endif
+#include "platform/execution-level-msip.hpp"
+#include "platform/executor-idle-mtimer.hpp"
+#include "debug/pc_sampler.hpp"
 
 #if defined(HOST_EMULATION)
-using mtimer_clock = std::chrono::steady_clock;
+using mtimer_clock = host_clock;
 #endif
 
 #if defined(HOST_EMULATION)
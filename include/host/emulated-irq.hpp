@@ -0,0 +1,264 @@
+/*
+   Host emulation of the interrupt lines and timer compare of a hart.
+
+   Used to block the emulated CPU in wfi() until the timer compare
+   expires or an interrupt is injected, and to take the interrupts
+   on the hart thread when they are enabled.
+
+   SPDX-License-Identifier: Unlicense
+
+   https://five-embeddev.com/
+
+*/
+
+#ifndef EMULATED_IRQ_HPP
+#define EMULATED_IRQ_HPP
+
+#include <cstdint>
+#include <array>
+#include <chrono>
+#include <mutex>
+#include <thread>
+#include <condition_variable>
+
+#include "virtual-clock.hpp"
+#include "../riscv/riscv-interrupts.hpp"
+
+#if defined(HOST_VIRTUAL_TIME)
+/** Host clock, time is advanced by the emulation */
+using host_clock = host::virtual_clock;
+#else
+/** Host clock, real time */
+using host_clock = std::chrono::steady_clock;
+#endif
+
+namespace host {
+
+    /** Emulated pending interrupts (mip), mtimecmp and periodic interrupt sources.
+
+        There are three kinds of interrupt lines:
+        - raise()      Edge, e.g. an external interrupt. Cleared when the interrupt is taken (claimed).
+        - set_level()  Level, e.g. msip. Cleared by the handler.
+        - mtimecmp     Pending while mtime >= mtimecmp.
+
+        Interrupts are taken on the hart thread by calling the interrupt entry
+        when interrupts are enabled, so the handler never runs concurrently with
+        the interrupted code. Periodic sources raise an edge at a fixed period
+        and are deterministic with virtual time.
+     */
+    class emulated_irq {
+      public:
+        static constexpr std::uint32_t MTI_BIT = std::uint32_t{ 1 } << riscv::interrupts::mti;
+        /** Maximum number of periodic sources */
+        static constexpr std::size_t MAX_SOURCES = 4;
+
+        /** Inject an interrupt, wakes the CPU if it is waiting on the interrupt.
+            When called from the hart thread the interrupt is taken immediately if enabled.
+         */
+        void raise(std::uint32_t cause) {
+            {
+                std::lock_guard<std::mutex> lock(mutex_);
+                raised_ |= std::uint32_t{ 1 } << cause;
+                wakeup_.notify_all();
+            }
+            enter_on_hart();
+        }
+
+        /** Clear an injected interrupt. */
+        void lower(std::uint32_t cause) {
+            std::lock_guard<std::mutex> lock(mutex_);
+            raised_ &= ~(std::uint32_t{ 1 } << cause);
+        }
+
+        /** Set or clear a level interrupt.
+            When set from the hart thread the interrupt is taken immediately if enabled.
+         */
+        void set_level(std::uint32_t cause, bool value) {
+            {
+                std::lock_guard<std::mutex> lock(mutex_);
+                if (value) {
+                    level_ |= std::uint32_t{ 1 } << cause;
+                }
+                else {
+                    level_ &= ~(std::uint32_t{ 1 } << cause);
+                }
+                wakeup_.notify_all();
+            }
+            if (value) {
+                enter_on_hart();
+            }
+        }
+
+        /** Acknowledge an interrupt that is being taken, edge interrupts are cleared. */
+        void claim(std::uint32_t cause) {
+            lower(cause);
+        }
+
+        /** Raise an edge interrupt every period, starting one period from now.
+            @retval false There are no free sources.
+         */
+        bool add_source(std::uint32_t cause, host_clock::duration period) {
+            std::lock_guard<std::mutex> lock(mutex_);
+            if (source_count_ == MAX_SOURCES || period <= host_clock::duration::zero()) {
+                return false;
+            }
+            sources_[source_count_++] = periodic_source{ cause, period, host_clock::now() + period, 0 };
+            wakeup_.notify_all();
+            return true;
+        }
+
+        /** Number of times the periodic sources for a cause have fired.
+         */
+        std::uint64_t source_count(std::uint32_t cause) {
+            std::lock_guard<std::mutex> lock(mutex_);
+            std::uint64_t count{ 0 };
+            for (std::size_t i = 0; i < source_count_; i++) {
+                if (sources_[i].cause == cause) {
+                    count += sources_[i].count;
+                }
+            }
+            return count;
+        }
+
+        /** Set the absolute timer compare time. */
+        void set_mtimecmp(host_clock::time_point mtimecmp) {
+            std::lock_guard<std::mutex> lock(mutex_);
+            mtimecmp_ = mtimecmp;
+            wakeup_.notify_all();
+        }
+
+        host_clock::time_point mtimecmp(void) {
+            std::lock_guard<std::mutex> lock(mutex_);
+            return mtimecmp_;
+        }
+
+        /** Pending interrupts, one bit per cause. The timer is pending when mtime >= mtimecmp. */
+        std::uint32_t pending(void) {
+            std::lock_guard<std::mutex> lock(mutex_);
+            return pending_locked();
+        }
+
+        /** Block until an interrupt in the enabled mask (mie) is pending.
+            With virtual time the clock is fast forwarded to the next timer or source deadline instead of sleeping.
+         */
+        void wait(std::uint32_t enabled) {
+            std::unique_lock<std::mutex> lock(mutex_);
+            auto ready = [&]() { return (pending_locked() & enabled) != 0; };
+            if (ready()) {
+#if defined(HOST_VIRTUAL_TIME)
+                // Time passes on each wakeup, so a timer set to expire now is passed.
+                host_clock::advance(host_clock::duration::zero());
+#endif
+                return;
+            }
+            const auto deadline = next_deadline_locked(enabled);
+#if defined(HOST_VIRTUAL_TIME)
+            if (deadline != host_clock::time_point::max()) {
+                host_clock::advance_to(deadline);
+                // Update the periodic sources
+                (void)ready();
+                return;
+            }
+            wakeup_.wait(lock, ready);
+#else
+            if (deadline != host_clock::time_point::max()) {
+                wakeup_.wait_until(lock, deadline, ready);
+            }
+            else {
+                wakeup_.wait(lock, ready);
+            }
+#endif
+        }
+
+        /** Install the function that takes pending interrupts, it is called on the thread that installed it.
+            @param entry Interrupt entry, or nullptr to remove it.
+         */
+        void set_interrupt_entry(void (*entry)(void)) {
+            std::lock_guard<std::mutex> lock(mutex_);
+            entry_ = entry;
+            hart_ = std::this_thread::get_id();
+        }
+
+        /** Take the pending and enabled interrupts if called on the hart thread.
+            Called when interrupts are enabled.
+         */
+        void enter_on_hart(void) {
+            void (*entry)(void){ nullptr };
+            {
+                std::lock_guard<std::mutex> lock(mutex_);
+                if (hart_ == std::this_thread::get_id()) {
+                    entry = entry_;
+                }
+            }
+            if (entry) {
+                entry();
+            }
+        }
+
+        /** Remove all injected interrupts, sources and the timer compare. */
+        void reset(void) {
+            std::lock_guard<std::mutex> lock(mutex_);
+            raised_ = 0;
+            level_ = 0;
+            source_count_ = 0;
+            mtimecmp_ = host_clock::time_point::max();
+        }
+
+      private:
+        struct periodic_source {
+            std::uint32_t cause;
+            host_clock::duration period;
+            host_clock::time_point next;
+            std::uint64_t count;
+        };
+
+        std::uint32_t pending_locked(void) {
+            const auto now = host_clock::now();
+            for (std::size_t i = 0; i < source_count_; i++) {
+                auto& source = sources_[i];
+                if (now >= source.next) {
+                    // Missed periods are merged into one edge.
+                    raised_ |= std::uint32_t{ 1 } << source.cause;
+                    source.count++;
+                    while (now >= source.next) {
+                        source.next += source.period;
+                    }
+                }
+            }
+            return raised_ | level_ | ((now >= mtimecmp_) ? MTI_BIT : 0);
+        }
+
+        host_clock::time_point next_deadline_locked(std::uint32_t enabled) const {
+            auto deadline = (enabled & MTI_BIT) ? mtimecmp_ : host_clock::time_point::max();
+            for (std::size_t i = 0; i < source_count_; i++) {
+                const auto& source = sources_[i];
+                if ((enabled & (std::uint32_t{ 1 } << source.cause)) && source.next < deadline) {
+                    deadline = source.next;
+                }
+            }
+            return deadline;
+        }
+
+        std::mutex mutex_;
+        std::condition_variable wakeup_;
+        std::uint32_t raised_{ 0 };
+        std::uint32_t level_{ 0 };
+        host_clock::time_point mtimecmp_{ host_clock::time_point::max() };
+        std::array<periodic_source, MAX_SOURCES> sources_{};
+        std::size_t source_count_{ 0 };
+        void (*entry_)(void){ nullptr };
+        std::thread::id hart_{};
+    };
+
+    /** Maximum number of emulated harts */
+    static constexpr std::size_t MAX_HARTS = 8;
+
+    /** Interrupt lines of each emulated hart, e.g. the msip of a secondary hart. */
+    inline std::array<emulated_irq, MAX_HARTS> hart_irq_lines;
+
+    /** Interrupt lines of the emulated hart 0, the thread that runs main(). */
+    inline emulated_irq& irq_lines = hart_irq_lines[0];
+
+}// namespace host
+
+#endif// EMULATED_IRQ_HPP
@@ -0,0 +1,46 @@
+/*
+   Simple host emulation for the machine software interrupt driver.
+   SPDX-License-Identifier: Unlicense
+
+   https://five-embeddev.com/
+
+*/
+
+#ifndef MSIP_HPP
+#define MSIP_HPP
+
+#include "emulated-irq.hpp"
+
+namespace driver {
+
+    /** Simple machine software interrupt driver class.
+        The emulated msip register drives the emulated software interrupt line of a hart.
+        ADDRESS_SPEC is not used, it is kept for compatibility with the target driver.
+     */
+    template<class ADDRESS_SPEC = void>
+    class msip {
+      public:
+        /** @param hart The hart that is interrupted. */
+        explicit msip(std::size_t hart = 0)
+            : lines_{ host::hart_irq_lines[hart % host::MAX_HARTS] } {
+        }
+        /** Raise the software interrupt */
+        void set(void) {
+            lines_.set_level(riscv::interrupts::msi, true);
+        }
+        /** Clear the software interrupt */
+        void clear(void) {
+            lines_.set_level(riscv::interrupts::msi, false);
+        }
+        /** Test if the software interrupt is raised */
+        bool pending(void) {
+            return (lines_.pending() & (std::uint32_t{ 1 } << riscv::interrupts::msi)) != 0;
+        }
+
+      private:
+        host::emulated_irq& lines_;
+    };
+
+}// namespace driver
+
+#endif// #ifdef MSIP_HPP
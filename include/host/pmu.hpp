@@ -0,0 +1,166 @@
+/*
+   Host emulation of the hardware performance counter driver, using Linux perf events.
+   SPDX-License-Identifier: Unlicense
+
+   https://five-embeddev.com/
+
+*/
+
+#ifndef PMU_HPP
+#define PMU_HPP
+
+#include <array>
+#include <cstddef>
+#include <cstdint>
+
+#if defined(__linux__)
+#include <cstring>
+#include <linux/perf_event.h>
+#include <sys/ioctl.h>
+#include <sys/syscall.h>
+#include <unistd.h>
+#endif
+
+namespace driver {
+
+    /** Portable performance events, mapped to the perf hardware events. */
+    enum class pmu_event : std::uint8_t {
+        cycles,
+        instructions,
+        branches,
+        branch_misses,
+        cache_references,
+        cache_misses,
+    };
+
+    /** A group of performance counters, started and stopped together.
+
+        The events are counted for the calling thread, i.e. one emulated hart.
+        An event is not supported if perf_event_open() fails, e.g. there is no
+        PMU or /proc/sys/kernel/perf_event_paranoid does not allow it.
+        EVENT_SPEC is not used, it is kept for compatibility with the target driver.
+     */
+    template<std::size_t N, class EVENT_SPEC = void>
+    class pmu {
+      public:
+        /** Open the perf events, as a group led by the first supported event.
+         */
+        explicit pmu(const std::array<pmu_event, N>& events)
+            : events_{ events } {
+            fds_.fill(-1);
+#if defined(__linux__)
+            for (std::size_t i = 0; i < N; i++) {
+                perf_event_attr attr;
+                std::memset(&attr, 0, sizeof(attr));
+                attr.size = sizeof(attr);
+                attr.type = PERF_TYPE_HARDWARE;
+                attr.config = config(events_[i]);
+                attr.disabled = (leader_ < 0) ? 1 : 0;
+                attr.exclude_kernel = 1;
+                attr.exclude_hv = 1;
+                fds_[i] = static_cast<int>(syscall(SYS_perf_event_open, &attr, 0, -1, leader_, 0));
+                if (leader_ < 0 && fds_[i] >= 0) {
+                    leader_ = fds_[i];
+                }
+            }
+#endif
+        }
+
+        ~pmu() {
+#if defined(__linux__)
+            // Close the members before the leader.
+            for (std::size_t i = N; i > 0; i--) {
+                if (fds_[i - 1] >= 0) {
+                    close(fds_[i - 1]);
+                }
+            }
+#endif
+        }
+
+        // The pmu is intended to be instanciated once.
+        pmu(const pmu&) = delete;
+        pmu(pmu&&) = delete;
+        pmu& operator=(const pmu&) = delete;
+        pmu& operator=(pmu&&) = delete;
+
+        /** Start counting. */
+        void start(void) {
+            for (std::size_t i = 0; i < N; i++) {
+                start_[i] = read(i);
+            }
+#if defined(__linux__)
+            if (leader_ >= 0) {
+                ioctl(leader_, PERF_EVENT_IOC_ENABLE, PERF_IOC_FLAG_GROUP);
+            }
+#endif
+        }
+        /** Stop counting, add the counts since start(). */
+        void stop(void) {
+#if defined(__linux__)
+            if (leader_ >= 0) {
+                ioctl(leader_, PERF_EVENT_IOC_DISABLE, PERF_IOC_FLAG_GROUP);
+            }
+#endif
+            for (std::size_t i = 0; i < N; i++) {
+                total_[i] += read(i) - start_[i];
+            }
+        }
+        /** Clear the counts. */
+        void reset(void) {
+            total_ = {};
+        }
+        /** Count of an event between start() and stop(). */
+        std::uint64_t value(std::size_t i) const {
+            return total_[i];
+        }
+        /** Test if the event is counted on this host. */
+        bool supported(std::size_t i) const {
+            return fds_[i] >= 0;
+        }
+        const std::array<pmu_event, N>& events(void) const {
+            return events_;
+        }
+
+      private:
+#if defined(__linux__)
+        static std::uint64_t config(pmu_event event) {
+            switch (event) {
+            case pmu_event::cycles:
+                return PERF_COUNT_HW_CPU_CYCLES;
+            case pmu_event::instructions:
+                return PERF_COUNT_HW_INSTRUCTIONS;
+            case pmu_event::branches:
+                return PERF_COUNT_HW_BRANCH_INSTRUCTIONS;
+            case pmu_event::branch_misses:
+                return PERF_COUNT_HW_BRANCH_MISSES;
+            case pmu_event::cache_references:
+                return PERF_COUNT_HW_CACHE_REFERENCES;
+            case pmu_event::cache_misses:
+                return PERF_COUNT_HW_CACHE_MISSES;
+            }
+            return PERF_COUNT_HW_CPU_CYCLES;
+        }
+#endif
+
+        std::uint64_t read(std::size_t i) const {
+            std::uint64_t value{ 0 };
+#if defined(__linux__)
+            if (fds_[i] >= 0 && ::read(fds_[i], &value, sizeof(value)) != sizeof(value)) {
+                value = 0;
+            }
+#else
+            (void)i;
+#endif
+            return value;
+        }
+
+        const std::array<pmu_event, N> events_;
+        std::array<int, N> fds_;
+        int leader_{ -1 };
+        std::array<std::uint64_t, N> start_{};
+        std::array<std::uint64_t, N> total_{};
+    };
+
+}// namespace driver
+
+#endif// #ifdef PMU_HPP
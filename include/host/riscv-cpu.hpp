@@ -9,19 +9,123 @@
 #ifndef RISCV_CPU_HPP
 #define RISCV_CPU_HPP
 
+#include <cstdint>
+#include <cstdio>
+#include <cstdlib>
+#include <cstring>
+#include <chrono>
+#include <ctime>
+
+#include "emulated-irq.hpp"
+#include "smp.hpp"
+#include "../debug/trace.hpp"
+#include "../debug/task_accounting.hpp"
+#include "../debug/jitter.hpp"
+
 namespace riscv {
 
+    /** Idle statistics of the emulated CPU */
+    struct wfi_stats {
+        //! Number of times wfi() returned.
+        std::uint64_t wakeups;
+        //! Time spent blocked in wfi().
+        host_clock::duration idle;
+    };
+
     template<class CSR_T, class TIMER_T>
     class cpu {
       public:
-        cpu(int argc, const char** argv, CSR_T& csrs, TIMER_T& timer) {
-            (void)argc;
-            (void)argv;
-            (void)csrs;
+        /** Create the emulated CPU.
+            Options:
+              --wakeups N             Print the idle statistics and exit after N wakeups.
+              --irq CAUSE:PERIOD_US   Raise interrupt CAUSE every PERIOD_US microseconds.
+              --harts N               Number of emulated harts, see riscv::smp::secondary_harts.
+              --trace FILE            Write the event trace of hart 0 to FILE on exit, see trace_to_chrome.py.
+         */
+        cpu(int argc, const char** argv, CSR_T& csrs, TIMER_T& timer)
+            : csrs_{ csrs }
+            , start_{ host_clock::now() } {
             (void)timer;
+            for (int i = 1; i + 1 < argc; i++) {
+                if (std::strcmp(argv[i], "--wakeups") == 0) {
+                    wakeup_limit_ = std::strtoull(argv[i + 1], nullptr, 0);
+                }
+                else if (std::strcmp(argv[i], "--trace") == 0) {
+                    trace_file_ = argv[i + 1];
+                }
+                else if (std::strcmp(argv[i], "--harts") == 0) {
+                    riscv::smp::emulated_harts = std::strtoul(argv[i + 1], nullptr, 0);
+                }
+                else if (std::strcmp(argv[i], "--irq") == 0) {
+                    char* period{ nullptr };
+                    auto cause = std::strtoul(argv[i + 1], &period, 0);
+                    if (*period == ':') {
+                        host::irq_lines.add_source(static_cast<std::uint32_t>(cause),
+                                                   std::chrono::microseconds(std::strtoul(period + 1, nullptr, 0)));
+                    }
+                }
+            }
         }
+
+        /** Block until an enabled interrupt (mie) is pending, as the hardware wfi.
+         */
         void wfi() {
+            const auto idle_start = host_clock::now();
+            host::irq_lines.wait(csrs_.mie.read());
+            stats_.idle += host_clock::now() - idle_start;
+            // Take the interrupt now if interrupts are enabled.
+            host::irq_lines.enter_on_hart();
+            stats_.wakeups++;
+            if (wakeup_limit_ && stats_.wakeups >= wakeup_limit_) {
+                print_stats(stdout);
+#if defined(ENABLE_TASK_ACCOUNTING)
+                task_account_manager::print(stdout);
+#endif
+#if defined(ENABLE_WAKEUP_JITTER)
+                jitter_log_manager::print(stdout);
+#endif
+                write_trace();
+                std::exit(0);
+            }
         }
+
+        const wfi_stats& stats() const {
+            return stats_;
+        }
+
+        /** Print wakeups/sec and the CPU usage since the CPU was created.
+         */
+        void print_stats(FILE* out) const {
+            const double elapsed = std::chrono::duration<double>(host_clock::now() - start_).count();
+            const double idle = std::chrono::duration<double>(stats_.idle).count();
+            const double cpu_time = static_cast<double>(std::clock()) / CLOCKS_PER_SEC;
+            fprintf(out, "wakeups=%llu elapsed=%.6fs idle=%.6fs wakeups/s=%.1f cpu=%.6fs\n",
+                    static_cast<unsigned long long>(stats_.wakeups),
+                    elapsed,
+                    idle,
+                    elapsed > 0 ? static_cast<double>(stats_.wakeups) / elapsed : 0.0,
+                    cpu_time);
+        }
+
+        /** Write the event trace to the --trace file.
+         */
+        void write_trace() const {
+#if TRACE_CATEGORIES != 0
+            if (trace_file_) {
+                if (FILE* out = fopen(trace_file_, "wb")) {
+                    trace_log_manager::dump(out);
+                    fclose(out);
+                }
+            }
+#endif
+        }
+
+      private:
+        CSR_T& csrs_;
+        const host_clock::time_point start_;
+        wfi_stats stats_{};
+        std::uint64_t wakeup_limit_{ 0 };
+        const char* trace_file_{ nullptr };
     };
 
 }// namespace riscv
@@ -9,8 +9,12 @@
 #ifndef RISCV_CSR_HPP
 #define RISCV_CSR_HPP
 
+#include <atomic>
 #include <cstdint>
 
+#include "../riscv/riscv-interrupts.hpp"
+#include "emulated-irq.hpp"
+
 namespace riscv {
 
     using uint_xlen_t = std::uint32_t;
@@ -43,26 +47,53 @@ namespace riscv {
         void clr() {
             value_ = false;
         }
+        bool read() const {
+            return value_;
+        }
 
       private:
-        bool value_;
+        std::atomic<bool> value_{ false };
+    };
+
+    /** Interrupt enable bit, pending interrupts may be taken when it is set. */
+    class irq_enable_emul : public bit_emul {
+      public:
+        void set() {
+            bit_emul::set();
+            host::irq_lines.enter_on_hart();
+        }
     };
 
     class mie_emul {
       public:
-        bit_emul mti;
+        irq_enable_emul mti;
+        irq_enable_emul msi;
+        irq_enable_emul mei;
+
+        /** Enabled interrupts, one bit per cause. */
+        uint_xlen_t read() const {
+            return (uint_xlen_t{ mti.read() } << interrupts::mti)
+                   | (uint_xlen_t{ msi.read() } << interrupts::msi)
+                   | (uint_xlen_t{ mei.read() } << interrupts::mei);
+        }
     };
 
     class mstatus_emul {
       public:
-        bit_emul mie;
+        irq_enable_emul mie;
     };
 
     class mcause_emul {
       public:
-        unsigned int read() {
-            return 0;
+        uint_xlen_t read() {
+            return value_;
+        }
+        void write(uint_xlen_t value) {
+            value_ = value;
         }
+
+      private:
+        std::atomic<uint_xlen_t> value_{ 0 };
     };
 
 
@@ -72,7 +103,7 @@ namespace riscv {
         mie_emul mie;
         mstatus_emul mstatus;
     };
-    static csr_s csrs;
+    inline csr_s csrs;
 
 };// namespace riscv
 
@@ -10,14 +10,66 @@
 #define RISCV_IRQ_HPP
 
 #include "riscv-csr.hpp"
+#include "emulated-irq.hpp"
 
+#include <array>
+#include <cstdint>
 #include <functional>
 
+#include "../debug/trace.hpp"
+
 namespace riscv {
 
     // Place the IRQ related code in a seperate namespace
     namespace irq {
 
+        /** Number of entries in the vector table. */
+        static constexpr std::uint32_t VECTOR_TABLE_SIZE = 12;
+
+        /** Emulated mtvec in direct mode, called for causes that have no vector. */
+        inline std::function<void(void)> direct_callback;
+
+        /** Emulated vector table, one callback per interrupt cause. */
+        inline std::array<std::function<void(void)>, VECTOR_TABLE_SIZE> vector_callbacks;
+
+        /** Select the pending interrupt to take, in the priority order MEI, MSI, MTI.
+         */
+        inline std::uint32_t highest_priority(std::uint32_t pending) {
+            for (auto cause : { interrupts::mei, interrupts::msi, interrupts::mti }) {
+                if (pending & (std::uint32_t{ 1 } << cause)) {
+                    return cause;
+                }
+            }
+            return static_cast<std::uint32_t>(__builtin_ctz(pending));
+        }
+
+        /** Emulated interrupt entry. Take the pending and enabled interrupts.
+            Called on the hart thread when interrupts are enabled, the handler is
+            called with interrupts disabled and mcause set, as on the target.
+         */
+        inline void take_interrupts(void) {
+            while (riscv::csrs.mstatus.mie.read()) {
+                const auto pending = host::irq_lines.pending() & riscv::csrs.mie.read();
+                if (!pending) {
+                    return;
+                }
+                const auto cause = highest_priority(pending);
+                const auto& callback = (cause < VECTOR_TABLE_SIZE && vector_callbacks[cause]) ? vector_callbacks[cause] : direct_callback;
+                if (!callback) {
+                    // No handler is installed.
+                    return;
+                }
+                host::irq_lines.claim(cause);
+                riscv::csrs.mcause.write(csr::mcause_data::interrupt::BIT_MASK | cause);
+                riscv::csrs.mstatus.mie.clr();
+                TRACE_EVENT(isr_enter, cause);
+                callback();
+                TRACE_EVENT(isr_exit, cause);
+                // mret, the interrupt enable is restored without re-entering.
+                riscv::csrs.mstatus.mie.bit_emul::set();
+            }
+        }
+
         /** IRQ Handler class. Allows a lambda function (or other function
          * object) to be registered as the machine mode IRQ hander.
          */
@@ -25,6 +77,11 @@ namespace riscv {
           public:
             handler(std::function<void(void)>&& isr_handler)
                 : irq_callback{ isr_handler } {
+                direct_callback = irq_callback;
+                host::irq_lines.set_interrupt_entry(take_interrupts);
+            }
+            ~handler() {
+                direct_callback = nullptr;
             }
 
             // Boilerplate delete defaults - non copyable class
@@ -35,6 +92,95 @@ namespace riscv {
 
             const std::function<void(void)> irq_callback;
         };
+
+        /** Disable interrupts for the lifetime of the object.
+            The previous interrupt enable state is restored, pending interrupts are taken on exit.
+         */
+        class critical_section {
+          public:
+            critical_section()
+                : mie_{ riscv::csrs.mstatus.mie.read() } {
+                riscv::csrs.mstatus.mie.clr();
+            }
+            ~critical_section() {
+                if (mie_) {
+                    riscv::csrs.mstatus.mie.set();
+                }
+            }
+
+            // Boilerplate delete defaults - non copyable class
+            critical_section(const critical_section&) = delete;
+            critical_section& operator=(const critical_section&) = delete;
+            critical_section(critical_section&&) = delete;
+            critical_section& operator=(critical_section&&) = delete;
+
+          private:
+            const bool mie_;
+        };
+
+        /** Enable nested interrupts from within an interrupt handler for the lifetime of the object.
+            Pending interrupts are taken (nested) on entry and while enabled.
+         */
+        class nested_enable {
+          public:
+            nested_enable()
+                : mcause_{ riscv::csrs.mcause.read() } {
+                riscv::csrs.mstatus.mie.set();
+            }
+            ~nested_enable() {
+                riscv::csrs.mstatus.mie.clr();
+                riscv::csrs.mcause.write(mcause_);
+            }
+
+            // Boilerplate delete defaults - non copyable class
+            nested_enable(const nested_enable&) = delete;
+            nested_enable& operator=(const nested_enable&) = delete;
+            nested_enable(nested_enable&&) = delete;
+            nested_enable& operator=(nested_enable&&) = delete;
+
+          private:
+            const uint_xlen_t mcause_;
+        };
+
+        /** The host emulation has no register save cost, the minimal entry is the same as handler. */
+        using minimal_handler = handler;
+
+        /** Bind a function object to an interrupt cause (riscv::interrupts).
+         */
+        template<std::uint32_t CAUSE, class T>
+        struct vector {
+            static_assert(CAUSE > 0 && CAUSE < VECTOR_TABLE_SIZE, "Interrupt cause is not in the vector table");
+            static constexpr std::uint32_t cause = CAUSE;
+            using handler_type = T;
+            T const& handler;
+        };
+
+        /** Create a vector entry binding isr_handler to an interrupt cause.
+         */
+        template<std::uint32_t CAUSE, class T>
+        vector<CAUSE, T> make_vector(T const& isr_handler) {
+            return { isr_handler };
+        }
+
+        /** IRQ Handler class. Registers one function object per interrupt cause.
+         */
+        template<class... VECTORS>
+        class vectored_handler {
+          public:
+            explicit vectored_handler(VECTORS const&... vectors) {
+                ((vector_callbacks[VECTORS::cause] = [&isr_handler = vectors.handler]() { isr_handler(); }), ...);
+                host::irq_lines.set_interrupt_entry(take_interrupts);
+            }
+            ~vectored_handler() {
+                ((vector_callbacks[VECTORS::cause] = nullptr), ...);
+            }
+
+            // Boilerplate delete defaults - non copyable class
+            vectored_handler(const vectored_handler&) = delete;
+            vectored_handler& operator=(const vectored_handler&) = delete;
+            vectored_handler(vectored_handler&&) = delete;
+            vectored_handler& operator=(vectored_handler&&) = delete;
+        };
     }// namespace irq
 
 }// namespace riscv
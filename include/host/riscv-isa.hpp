@@ -9,8 +9,12 @@
 #ifndef RISCV_ISA_HPP
 #define RISCV_ISA_HPP
 
-static void wfi() {
-    // Nop (pthread yeild?)
+#include "riscv-csr.hpp"
+#include "emulated-irq.hpp"
+
+/** Block until an enabled interrupt is pending. */
+inline void wfi() {
+    host::irq_lines.wait(riscv::csrs.mie.read());
 }
 
 #endif
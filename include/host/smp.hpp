@@ -0,0 +1,115 @@
+/*
+   Host emulation of multi-hart (SMP) support.
+
+   Each secondary hart is a std::thread, the hart id is thread local.
+   The thread that calls main() is hart 0.
+
+   SPDX-License-Identifier: Unlicense
+
+   https://five-embeddev.com/
+
+*/
+
+#ifndef SMP_HPP
+#define SMP_HPP
+
+#include <cstddef>
+#include <cstdint>
+#include <array>
+#include <thread>
+
+#include "emulated-irq.hpp"
+#include "riscv-csr.hpp"
+#include "msip.hpp"
+
+namespace riscv {
+
+    namespace smp {
+
+        /** Maximum number of emulated harts */
+        static constexpr std::size_t MAX_HARTS = host::MAX_HARTS;
+
+        /** Entry point of a secondary hart, called with the hart id. */
+        using hart_entry_t = void (*)(std::size_t);
+
+        /** Number of emulated harts, replaces __num_harts from the linker script. */
+        inline std::size_t emulated_harts{ 4 };
+
+        /** Id of the calling hart. */
+        inline thread_local std::size_t current_hart{ 0 };
+
+        inline std::size_t hart_id(void) {
+            return current_hart;
+        }
+
+        inline std::size_t hart_count(void) {
+            return (emulated_harts < MAX_HARTS) ? emulated_harts : MAX_HARTS;
+        }
+
+        /** Send an inter-processor interrupt, raise the emulated machine software interrupt of a hart.
+         */
+        inline void send_ipi(std::size_t hart) {
+            driver::msip<>{ hart }.set();
+        }
+
+        /** Block the calling hart until it receives an inter-processor interrupt, then clear it.
+            Also returns when the timer of the hart expires, if the timer interrupt is enabled (mie.mti).
+            The hart thread waits on the condition variable of its emulated interrupt lines.
+            NOTE - The emulated mie is shared by all harts.
+         */
+        inline void wait_ipi(void) {
+            auto& lines = host::hart_irq_lines[hart_id()];
+            lines.wait((std::uint32_t{ 1 } << riscv::interrupts::msi) | (riscv::csrs.mie.read() & (std::uint32_t{ 1 } << riscv::interrupts::mti)));
+            lines.set_level(riscv::interrupts::msi, false);
+        }
+
+        /** Hart identity and wakeup for the SMP executor.
+         */
+        struct this_hart {
+            static std::size_t id(void) {
+                return hart_id();
+            }
+            static void wake(std::size_t hart) {
+                send_ipi(hart);
+            }
+            static void wait(void) {
+                wait_ipi();
+            }
+        };
+
+        /** Start the secondary harts 1 .. hart_count() - 1, each calls entry(hart_id) on a new thread.
+            The threads are joined on destruction, so entry must return on the host.
+         */
+        class secondary_harts {
+          public:
+            explicit secondary_harts(hart_entry_t entry) {
+                for (std::size_t hart = 1; hart < hart_count(); hart++) {
+                    harts_[hart] = std::thread([entry, hart]() {
+                        current_hart = hart;
+                        entry(hart);
+                    });
+                }
+            }
+            ~secondary_harts() {
+                for (auto& hart : harts_) {
+                    if (hart.joinable()) {
+                        hart.join();
+                    }
+                }
+            }
+
+            // Boilerplate delete defaults - non copyable class
+            secondary_harts(const secondary_harts&) = delete;
+            secondary_harts& operator=(const secondary_harts&) = delete;
+            secondary_harts(secondary_harts&&) = delete;
+            secondary_harts& operator=(secondary_harts&&) = delete;
+
+          private:
+            std::array<std::thread, MAX_HARTS> harts_;
+        };
+
+    }// namespace smp
+
+}// namespace riscv
+
+#endif// SMP_HPP
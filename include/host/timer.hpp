@@ -9,9 +9,12 @@
 #ifndef TIMER_HPP
 #define TIMER_HPP
 
+#include <cstddef>
 #include <cstdint>
 #include <chrono>
 
+#include "emulated-irq.hpp"
+
 namespace driver {
 
     /** Simple TIMER driver class
@@ -19,13 +22,14 @@ namespace driver {
     template<class BASE_DURATION = std::chrono::microseconds>
     class timer {
       public:
-        timer()
-            : start_{ std::chrono::high_resolution_clock::now() } {
-        }
-
         /** Duration of each timer tick */
         using timer_ticks = std::chrono::microseconds;
 
+        /** @param hart The emulated hart that owns the timer compare. */
+        explicit timer(std::size_t hart = 0)
+            : lines_{ host::hart_irq_lines[hart % host::MAX_HARTS] } {
+        }
+
         /** Set the timer compare point using a std::chrono::duration timer offset
          */
         template<class T = BASE_DURATION>
@@ -41,17 +45,19 @@ namespace driver {
         /** Set the time compare point in ticks of the system timer counter.
          */
         void set_ticks_time_cmp(timer_ticks time_offset) {
-            mtimecmp_ = time_offset;
+            // An interrupt will be generated at mtime + time_offset.
+            lines_.set_mtimecmp(host_clock::now() + time_offset);
         }
         /** Return the current system time as a duration since the mtime counter was initialized
          */
         timer_ticks get_ticks_time(void) {
-            return std::chrono::duration_cast<timer_ticks>(std::chrono::high_resolution_clock::now() - start_);
+            return std::chrono::duration_cast<timer_ticks>(host_clock::now() - start_);
         }
 
       private:
-        timer_ticks mtimecmp_;
-        const std::chrono::time_point<std::chrono::high_resolution_clock> start_;
+        host::emulated_irq& lines_;
+        // Emulated mtime epoch, shared by all driver instances as on the target.
+        static inline const host_clock::time_point start_{ host_clock::now() };
     };
 
 }// namespace driver
@@ -0,0 +1,64 @@
+/*
+   Virtual time clock for host emulation.
+
+   Time only advances when it is explicitly moved forward, e.g. when
+   the emulated CPU is idle waiting for the next timer deadline. This
+   makes timer driven tests fast and deterministic.
+
+   SPDX-License-Identifier: Unlicense
+
+   https://five-embeddev.com/
+
+*/
+
+#ifndef VIRTUAL_CLOCK_HPP
+#define VIRTUAL_CLOCK_HPP
+
+#include <atomic>
+#include <chrono>
+
+namespace host {
+
+    // Traits for the scheduler
+    // This should mimic std::chrono::steady_clock
+    struct virtual_clock {
+        using duration = std::chrono::nanoseconds;
+        using rep = duration::rep;
+        using period = duration::period;
+        using time_point = std::chrono::time_point<virtual_clock>;
+        static constexpr bool is_steady = true;
+
+        static time_point now() noexcept {
+            return time_point(duration(now_.load()));
+        }
+
+        /** Move time forward by delay.
+            Time always advances by at least one tick, so a deadline
+            at the current time is passed.
+         */
+        static void advance(duration delay) noexcept {
+            now_.fetch_add(delay > duration::zero() ? delay.count() : 1);
+        }
+
+        /** Move time forward to a deadline, time never goes backwards.
+            Safe when several emulated harts fast forward at the same time.
+         */
+        static void advance_to(time_point deadline) noexcept {
+            auto current = now_.load();
+            const auto target = (deadline.time_since_epoch().count() > current) ? deadline.time_since_epoch().count() : current + 1;
+            while (current < target && !now_.compare_exchange_weak(current, target)) {
+            }
+        }
+
+        /** Restart time from zero. */
+        static void reset() noexcept {
+            now_.store(0);
+        }
+
+      private:
+        static inline std::atomic<rep> now_{ 0 };
+    };
+
+}// namespace host
+
+#endif// VIRTUAL_CLOCK_HPP
@@ -0,0 +1,37 @@
+/*
+   Execution level configuration to run co-routines at preemptive levels.
+
+   The levels are run from the machine software interrupt.
+   Shared by the target and the host emulation, the drivers of the
+   platform are included.
+
+   SPDX-License-Identifier: Unlicense
+
+   https://five-embeddev.com/
+
+*/
+
+#ifndef EXECUTION_LEVEL_MSIP_HPP
+#define EXECUTION_LEVEL_MSIP_HPP
+
+#if defined(HOST_EMULATION)
+#include "../host/msip.hpp"
+#include "../host/riscv-irq.hpp"
+#else
+#include "../riscv/msip.hpp"
+#include "../riscv/riscv-irq.hpp"
+#endif
+
+// Software interrupt traits for execution_levels
+struct msip_level_irq {
+    static void pend(void) {
+        driver::msip<>{}.set();
+    }
+    static void clear(void) {
+        driver::msip<>{}.clear();
+    }
+    using nested = riscv::irq::nested_enable;
+    using critical = riscv::irq::critical_section;
+};
+
+#endif
@@ -0,0 +1,79 @@
+/*
+   Idle policy for the executor, sleep in wfi until the next timer compare or an interrupt.
+   Shared by the target and the host emulation, the drivers of the
+   platform are included.
+
+   SPDX-License-Identifier: Unlicense
+
+   https://five-embeddev.com/
+
+*/
+
+#ifndef EXECUTOR_IDLE_MTIMER_HPP
+#define EXECUTOR_IDLE_MTIMER_HPP
+
+#include <chrono>
+#include <optional>
+
+#if defined(HOST_EMULATION)
+#include "../host/riscv-csr.hpp"
+#include "../host/timer.hpp"
+#else
+#include "../riscv/riscv-csr.hpp"
+#include "../riscv/timer.hpp"
+#endif
+#include "../debug/pc_sampler.hpp"
+
+/** Idle the executor with wfi, using mtimecmp to wake for the next delay.
+
+    The timer interrupt handler is expected to clear mie.mti, it is set again for each wait with a delay.
+
+    @tparam CPU  The cpu that implements wfi(), e.g. riscv_cpu_t.
+ */
+template<class CPU>
+class mtimer_idle {
+  public:
+    /** @param core           Used for wfi().
+        @param max_sleep      Wake up at least this often, 0 to sleep until an interrupt when there is no delay.
+        @param sample_period  PC sampling period, max_sleep is limited to it so the sample timer is not overwritten.
+     */
+    explicit mtimer_idle(CPU& core,
+                         std::chrono::microseconds max_sleep = std::chrono::microseconds::zero(),
+                         std::chrono::microseconds sample_period = pc_sample_max_sleep)
+        : core_{ core }
+        , max_sleep_{ pc_sample_sleep(max_sleep, sample_period) } {}
+
+    /** Sleep until the delay expires or an interrupt.
+        idle_test is called with interrupts disabled, so the interrupt enable and wfi are atomic.
+     */
+    template<class DURATION, class IDLE_TEST>
+    void wait(const std::optional<DURATION>& delay, IDLE_TEST idle_test) {
+        riscv::csrs.mstatus.mie.clr();
+        std::optional<std::chrono::microseconds> sleep;
+        if (delay) {
+            sleep = std::chrono::duration_cast<std::chrono::microseconds>(*delay);
+        }
+        if ((max_sleep_.count() != 0) && (!sleep || (*sleep > max_sleep_))) {
+            sleep = max_sleep_;
+        }
+        if (sleep) {
+            // Next wakeup
+            mtimer_.set_time_cmp(*sleep);
+            // Timer interrupt enable
+            riscv::csrs.mie.mti.set();
+        }
+        // WFI Should be called while interrupts are disabled
+        // to ensure interrupt enable and WFI is atomic.
+        if (idle_test()) {
+            core_.wfi();
+        }
+        riscv::csrs.mstatus.mie.set();
+    }
+
+  private:
+    CPU& core_;
+    driver::timer<> mtimer_;
+    const std::chrono::microseconds max_sleep_;
+};
+
+#endif// EXECUTOR_IDLE_MTIMER_HPP
@@ -0,0 +1,56 @@
+/*
+   Machine software interrupt driver for the RISC-V CLINT msip register.
+   SPDX-License-Identifier: Unlicense
+
+   https://five-embeddev.com/
+
+*/
+
+#ifndef MSIP_HPP
+#define MSIP_HPP
+
+#include <cstddef>
+#include <cstdint>
+
+namespace driver {
+
+    /** Default definition of the memory mapped msip registers, one per hart.
+    The addresses here are from freedom-e-sdk/bsp/sifive-hifive1-revb/design.svd
+    */
+    struct msip_address_spec {
+        static constexpr std::uintptr_t MSIP_ADDR = 0x2000000;
+        static constexpr std::uintptr_t MSIP_HART_STRIDE = 4;
+    };
+
+    /** Simple machine software interrupt driver class.
+        Writing 1 to msip raises the machine software interrupt (mip.msi) of a hart,
+        i.e. an inter-processor interrupt when it is another hart.
+     */
+    template<class ADDRESS_SPEC = msip_address_spec>
+    class msip {
+      public:
+        /** @param hart The hart that is interrupted. */
+        explicit msip(std::size_t hart = 0)
+            : reg_{ reinterpret_cast<volatile std::uint32_t*>(ADDRESS_SPEC::MSIP_ADDR + hart * ADDRESS_SPEC::MSIP_HART_STRIDE) } {
+        }
+
+        /** Raise the software interrupt */
+        void set(void) {
+            *reg_ = 1;
+        }
+        /** Clear the software interrupt */
+        void clear(void) {
+            *reg_ = 0;
+        }
+        /** Test if the software interrupt is raised */
+        bool pending(void) {
+            return (*reg_ & 1) != 0;
+        }
+
+      private:
+        volatile std::uint32_t* const reg_;
+    };
+
+}// namespace driver
+
+#endif// #ifdef MSIP_HPP
@@ -0,0 +1,205 @@
+/*
+   Hardware performance counter driver, over mcycle, minstret and the
+   mhpmcounter/mhpmevent CSRs.
+   SPDX-License-Identifier: Unlicense
+
+   https://five-embeddev.com/
+
+*/
+
+#ifndef PMU_HPP
+#define PMU_HPP
+
+#include <array>
+#include <cstddef>
+#include <cstdint>
+#include <utility>
+
+namespace driver {
+
+    /** Portable performance events, see the EVENT_SPEC of the pmu for the hardware encoding. */
+    enum class pmu_event : std::uint8_t {
+        cycles,
+        instructions,
+        branches,
+        branch_misses,
+        cache_references,
+        cache_misses,
+    };
+
+    /** mhpmevent encodings of the SiFive E3x/E2x core complex hardware performance monitor.
+        Bits [7:0] are the event class, the higher bits are the events counted in that class.
+        0 is no event, the counter is not supported.
+     */
+    struct sifive_pmu_event_spec {
+        //! Number of mhpmcounters, mhpmcounter3 and mhpmcounter4.
+        static constexpr std::size_t counters = 2;
+
+        static constexpr std::uint32_t encode(pmu_event event) {
+            switch (event) {
+            case pmu_event::branches:
+                return (1u << 14) | 0;// Conditional branch retired.
+            case pmu_event::branch_misses:
+                return (1u << 13) | (1u << 14) | 1;// Branch direction or target misprediction.
+            case pmu_event::cache_references:
+                return (1u << 9) | (1u << 10) | 0;// Integer load or store retired.
+            case pmu_event::cache_misses:
+                return (1u << 9) | 2;// Data cache miss or memory-mapped I/O access.
+            default:
+                return 0;
+            }
+        }
+    };
+
+    /** A group of performance counters, started and stopped together.
+
+        Cycles and instructions use mcycle and minstret. The other events are
+        given mhpmcounter3, mhpmcounter4... in order, programmed by mhpmevent
+        with EVENT_SPEC::encode(). Events after the last of EVENT_SPEC::counters
+        are not supported. The counters are free running, start() and stop()
+        accumulate the difference, so mcountinhibit is not used.
+
+        @tparam N           Number of events in the group.
+        @tparam EVENT_SPEC  Encoding of the events in mhpmevent and number of counters.
+     */
+    template<std::size_t N, class EVENT_SPEC = sifive_pmu_event_spec>
+    class pmu {
+        static constexpr std::size_t HPM_COUNTERS = EVENT_SPEC::counters;
+        static_assert(HPM_COUNTERS <= 29, "mhpmcounter3 to mhpmcounter31 are available");
+
+      public:
+        /** Assign the counters and program the event selectors.
+         */
+        explicit pmu(const std::array<pmu_event, N>& events)
+            : events_{ events }
+            , hpm_{ allocate(events) } {
+            program(std::make_index_sequence<HPM_COUNTERS>{});
+        }
+
+        // The pmu is intended to be instanciated once.
+        pmu(const pmu&) = delete;
+        pmu(pmu&&) = delete;
+        pmu& operator=(const pmu&) = delete;
+        pmu& operator=(pmu&&) = delete;
+
+        /** Start counting. */
+        void start(void) {
+            for (std::size_t i = 0; i < N; i++) {
+                start_[i] = read(i);
+            }
+        }
+        /** Stop counting, add the counts since start(). */
+        void stop(void) {
+            for (std::size_t i = 0; i < N; i++) {
+                total_[i] += read(i) - start_[i];
+            }
+        }
+        /** Clear the counts. */
+        void reset(void) {
+            total_ = {};
+        }
+        /** Count of an event between start() and stop(). */
+        std::uint64_t value(std::size_t i) const {
+            return total_[i];
+        }
+        /** Test if the event is counted by this core. */
+        bool supported(std::size_t i) const {
+            return fixed(events_[i]) || ((hpm_[i] < HPM_COUNTERS) && (EVENT_SPEC::encode(events_[i]) != 0));
+        }
+        const std::array<pmu_event, N>& events(void) const {
+            return events_;
+        }
+
+      private:
+        static constexpr bool fixed(pmu_event event) {
+            return event == pmu_event::cycles || event == pmu_event::instructions;
+        }
+
+        /** mhpmcounter index (from 3) of each event, counting only the events that are not fixed. */
+        static constexpr std::array<std::size_t, N> allocate(const std::array<pmu_event, N>& events) {
+            std::array<std::size_t, N> hpm{};
+            std::size_t next{ 0 };
+            for (std::size_t i = 0; i < N; i++) {
+                hpm[i] = fixed(events[i]) ? HPM_COUNTERS : next++;
+            }
+            return hpm;
+        }
+
+        /** Encoding of the event given counter hpm, 0 if it is not used. */
+        std::uint32_t encoding(std::size_t hpm) const {
+            for (std::size_t i = 0; i < N; i++) {
+                if (!fixed(events_[i]) && hpm_[i] == hpm) {
+                    return EVENT_SPEC::encode(events_[i]);
+                }
+            }
+            return 0;
+        }
+
+        template<std::size_t... H>
+        void program(std::index_sequence<H...>) {
+            (write_csr<0x323 + H>(encoding(H)), ...);
+        }
+
+        std::uint64_t read(std::size_t i) const {
+            switch (events_[i]) {
+            case pmu_event::cycles:
+                return read_counter<0xB00>();
+            case pmu_event::instructions:
+                return read_counter<0xB02>();
+            default:
+                return read_hpm(hpm_[i], std::make_index_sequence<HPM_COUNTERS>{});
+            }
+        }
+
+        /** Read mhpmcounter(3+hpm), 0 if there is no such counter. */
+        template<std::size_t... H>
+        static std::uint64_t read_hpm(std::size_t hpm, std::index_sequence<H...>) {
+            std::uint64_t value{ 0 };
+            (void)((hpm == H ? (value = read_counter<0xB03 + H>(), true) : false) || ...);
+            return value;
+        }
+
+        /** Read a 64 bit counter, on RV32 the upper half is at CSR + 0x80. */
+        template<unsigned int CSR>
+        static std::uint64_t read_counter(void) {
+#if __riscv_xlen == 32
+            std::uint32_t high, low, check;
+            do {
+                high = read_csr<CSR + 0x80>();
+                low = read_csr<CSR>();
+                check = read_csr<CSR + 0x80>();
+            } while (high != check);
+            return (std::uint64_t{ high } << 32) | low;
+#else
+            return read_csr<CSR>();
+#endif
+        }
+
+        template<unsigned int CSR>
+        static std::uintptr_t read_csr(void) {
+            std::uintptr_t value;
+            __asm__ volatile("csrr    %0, %1"
+                             : "=r"(value) /* output : register */
+                             : "i"(CSR) /* input : csr number */
+                             : /* clobbers: none */);
+            return value;
+        }
+
+        template<unsigned int CSR>
+        static void write_csr(std::uintptr_t value) {
+            __asm__ volatile("csrw    %0, %1"
+                             : /* output: none */
+                             : "i"(CSR), "r"(value) /* input : csr number, register */
+                             : /* clobbers: none */);
+        }
+
+        const std::array<pmu_event, N> events_;
+        //! Counter of each event, HPM_COUNTERS for cycles and instructions.
+        const std::array<std::size_t, N> hpm_;
+        std::array<std::uint64_t, N> start_{};
+        std::array<std::uint64_t, N> total_{};
+    };
+
+}// namespace driver
+
+#endif// #ifdef PMU_HPP
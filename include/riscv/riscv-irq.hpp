@@ -12,6 +12,9 @@
 #include "riscv-csr.hpp"
 
 #include <cstdint>
+#include <type_traits>
+
+#include "../debug/trace.hpp"
 
 namespace riscv {
 
@@ -63,8 +66,10 @@ namespace riscv {
             _execute_handler = [](void) {
                 // Read the context from the interrupt scratch register.
                 uintptr_t isr_context = riscv::csrs.mscratch.read();
+                TRACE_EVENT(isr_enter, riscv::csrs.mcause.read());
                 // Call into the lambda function.
-                return ((T*)isr_context)->operator()();
+                ((T*)isr_context)->operator()();
+                TRACE_EVENT(isr_exit, riscv::csrs.mcause.read());
             };
             // Get a pointer to the IRQ context and save in the interrupt scratch register.
             uintptr_t isr_context = (uintptr_t)&isr_handler;
@@ -84,6 +89,393 @@ namespace riscv {
 #pragma GCC pop_options
     }// namespace irq
 
+    // Interrupt enable scopes
+    namespace irq {
+
+        /** Disable machine mode interrupts for the lifetime of the object.
+            The previous interrupt enable state is restored, so scopes can be nested.
+         */
+        class critical_section {
+          public:
+            critical_section()
+                : mstatus_{ riscv::csrs.mstatus.read_clr_bits_const<riscv::csr::mstatus_data::mie::BIT_MASK>() } {
+            }
+            ~critical_section() {
+                riscv::csrs.mstatus.set(mstatus_ & riscv::csr::mstatus_data::mie::BIT_MASK);
+            }
+
+            // Boilerplate delete defaults - non copyable class
+            critical_section(const critical_section&) = delete;
+            critical_section& operator=(const critical_section&) = delete;
+            critical_section(critical_section&&) = delete;
+            critical_section& operator=(critical_section&&) = delete;
+
+          private:
+            const riscv::csr::uint_xlen_t mstatus_;
+        };
+
+        /** Enable nested interrupts from within an interrupt handler for the lifetime of the object.
+            mepc and mstatus (MPIE, MPP) are saved on entry, as a nested interrupt overwrites them,
+            and restored with interrupts disabled on exit.
+         */
+        class nested_enable {
+          public:
+            nested_enable()
+                : mepc_{ riscv::csrs.mepc.read() }
+                , mstatus_{ riscv::csrs.mstatus.read() } {
+                riscv::csrs.mstatus.mie.set();
+            }
+            ~nested_enable() {
+                riscv::csrs.mstatus.mie.clr();
+                riscv::csrs.mstatus.write(mstatus_);
+                riscv::csrs.mepc.write(mepc_);
+            }
+
+            // Boilerplate delete defaults - non copyable class
+            nested_enable(const nested_enable&) = delete;
+            nested_enable& operator=(const nested_enable&) = delete;
+            nested_enable(nested_enable&&) = delete;
+            nested_enable& operator=(nested_enable&&) = delete;
+
+          private:
+            const riscv::csr::uint_xlen_t mepc_;
+            const riscv::csr::uint_xlen_t mstatus_;
+        };
+    }// namespace irq
+
+    // Minimal register save IRQ handling
+    namespace irq {
+
+#if __riscv_xlen == 64
+#define RISCV_IRQ_STORE "sd"
+#define RISCV_IRQ_LOAD "ld"
+#else
+#define RISCV_IRQ_STORE "sw"
+#define RISCV_IRQ_LOAD "lw"
+#endif
+#if defined(__riscv_flen) && __riscv_flen == 64
+#define RISCV_IRQ_FSTORE "fsd"
+#define RISCV_IRQ_FLOAD "fld"
+#elif defined(__riscv_flen)
+#define RISCV_IRQ_FSTORE "fsw"
+#define RISCV_IRQ_FLOAD "flw"
+#endif
+
+        // Machine mode interrupt service routine
+        // Saves only the registers that are not preserved by a C++ function call
+        // (ra, t0-t6, a0-a7 and the floating point temporaries and fcsr when present).
+        // The callee saved registers are saved by the handler itself if they are used.
+        // Returns the address of the entry.
+        static std::uintptr_t minimal_entry(void);
+
+        /** IRQ Handler class. Allows a lambda function (or other function
+         * object) to be registered as the machine mode IRQ hander.
+         *
+         * Compared to handler this uses a hand written entry that saves only the
+         * caller saved registers and makes a single indirect call to the
+         * function object.
+         */
+        class minimal_handler {
+          public:
+            /** Create an IRQ handler class to install a
+                function as the machine mode irq handler */
+            template<class T>
+            minimal_handler(T const& isr_handler);
+
+            // Boilerplate delete defaults - non copyable class
+            minimal_handler(const minimal_handler&) = delete;
+            minimal_handler& operator=(const minimal_handler&) = delete;
+            minimal_handler(minimal_handler&&) = delete;
+            minimal_handler& operator=(minimal_handler&&) = delete;
+
+          private:
+            // Called from minimal_entry() with the context from mscratch as the argument.
+            static inline void (*_execute_handler)(const void*);
+            friend std::uintptr_t minimal_entry(void);
+        };
+
+        template<class T>
+        minimal_handler::minimal_handler(T const& isr_handler) {
+            // The function object type is known here, so the call to operator() is inlined.
+            _execute_handler = [](const void* isr_context) {
+                TRACE_EVENT(isr_enter, riscv::csrs.mcause.read());
+                static_cast<T const*>(isr_context)->operator()();
+                TRACE_EVENT(isr_exit, riscv::csrs.mcause.read());
+            };
+            // Get a pointer to the IRQ context and save in the interrupt scratch register.
+            riscv::csrs.mscratch.write(reinterpret_cast<std::uintptr_t>(&isr_handler));
+            // Write the entry() function to the mtvec register to install our IRQ handler.
+            riscv::csrs.mtvec.write(minimal_entry());
+        }
+
+        /** Size of the register save area, rounded up to keep the stack 16 byte aligned. */
+        static constexpr std::uintptr_t MINIMAL_ENTRY_XREGS = 16;
+#if defined(__riscv_flen)
+        // ft0-ft11, fa0-fa7 and fcsr in the last slot.
+        static constexpr std::uintptr_t MINIMAL_ENTRY_FREGS = 21;
+        static constexpr std::uintptr_t MINIMAL_ENTRY_FREG_SIZE = __riscv_flen / 8;
+#else
+        static constexpr std::uintptr_t MINIMAL_ENTRY_FREGS = 0;
+        static constexpr std::uintptr_t MINIMAL_ENTRY_FREG_SIZE = 0;
+#endif
+        static constexpr std::uintptr_t MINIMAL_ENTRY_FRAME =
+            ((MINIMAL_ENTRY_XREGS * sizeof(std::uintptr_t) + MINIMAL_ENTRY_FREGS * MINIMAL_ENTRY_FREG_SIZE + 15) / 16) * 16;
+
+        static std::uintptr_t minimal_entry(void) {
+            std::uintptr_t entry;
+            // Extended asm is not allowed in a naked function, so the entry is emitted from this function
+            // into its own section, aligned for mtvec.BASE.
+            __asm__(
+                ".pushsection .text.riscv_irq_minimal_entry,\"ax\",@progbits;"
+                ".balign 4;"
+                ".Lminimal_entry%=:"
+                "addi sp, sp, -%[frame];"
+                RISCV_IRQ_STORE " ra,  0*%[x](sp);"
+                RISCV_IRQ_STORE " t0,  1*%[x](sp);"
+                RISCV_IRQ_STORE " t1,  2*%[x](sp);"
+                RISCV_IRQ_STORE " t2,  3*%[x](sp);"
+                RISCV_IRQ_STORE " a0,  4*%[x](sp);"
+                RISCV_IRQ_STORE " a1,  5*%[x](sp);"
+                RISCV_IRQ_STORE " a2,  6*%[x](sp);"
+                RISCV_IRQ_STORE " a3,  7*%[x](sp);"
+                RISCV_IRQ_STORE " a4,  8*%[x](sp);"
+                RISCV_IRQ_STORE " a5,  9*%[x](sp);"
+                RISCV_IRQ_STORE " a6, 10*%[x](sp);"
+                RISCV_IRQ_STORE " a7, 11*%[x](sp);"
+                RISCV_IRQ_STORE " t3, 12*%[x](sp);"
+                RISCV_IRQ_STORE " t4, 13*%[x](sp);"
+                RISCV_IRQ_STORE " t5, 14*%[x](sp);"
+                RISCV_IRQ_STORE " t6, 15*%[x](sp);"
+#if defined(__riscv_flen)
+                RISCV_IRQ_FSTORE " ft0,  %[fp]+0*%[f](sp);"
+                RISCV_IRQ_FSTORE " ft1,  %[fp]+1*%[f](sp);"
+                RISCV_IRQ_FSTORE " ft2,  %[fp]+2*%[f](sp);"
+                RISCV_IRQ_FSTORE " ft3,  %[fp]+3*%[f](sp);"
+                RISCV_IRQ_FSTORE " ft4,  %[fp]+4*%[f](sp);"
+                RISCV_IRQ_FSTORE " ft5,  %[fp]+5*%[f](sp);"
+                RISCV_IRQ_FSTORE " ft6,  %[fp]+6*%[f](sp);"
+                RISCV_IRQ_FSTORE " ft7,  %[fp]+7*%[f](sp);"
+                RISCV_IRQ_FSTORE " ft8,  %[fp]+8*%[f](sp);"
+                RISCV_IRQ_FSTORE " ft9,  %[fp]+9*%[f](sp);"
+                RISCV_IRQ_FSTORE " ft10, %[fp]+10*%[f](sp);"
+                RISCV_IRQ_FSTORE " ft11, %[fp]+11*%[f](sp);"
+                RISCV_IRQ_FSTORE " fa0,  %[fp]+12*%[f](sp);"
+                RISCV_IRQ_FSTORE " fa1,  %[fp]+13*%[f](sp);"
+                RISCV_IRQ_FSTORE " fa2,  %[fp]+14*%[f](sp);"
+                RISCV_IRQ_FSTORE " fa3,  %[fp]+15*%[f](sp);"
+                RISCV_IRQ_FSTORE " fa4,  %[fp]+16*%[f](sp);"
+                RISCV_IRQ_FSTORE " fa5,  %[fp]+17*%[f](sp);"
+                RISCV_IRQ_FSTORE " fa6,  %[fp]+18*%[f](sp);"
+                RISCV_IRQ_FSTORE " fa7,  %[fp]+19*%[f](sp);"
+                // The rounding mode and exception flags of the interrupted code.
+                "frcsr t0;"
+                "sw t0, %[fp]+20*%[f](sp);"
+#endif
+                // The function object context is the only argument.
+                "csrr a0, mscratch;"
+                // Single indirect call into the function object.
+                "la t0, %[handler];"
+                RISCV_IRQ_LOAD " t0, 0(t0);"
+                "jalr ra, t0;"
+#if defined(__riscv_flen)
+                RISCV_IRQ_FLOAD " ft0,  %[fp]+0*%[f](sp);"
+                RISCV_IRQ_FLOAD " ft1,  %[fp]+1*%[f](sp);"
+                RISCV_IRQ_FLOAD " ft2,  %[fp]+2*%[f](sp);"
+                RISCV_IRQ_FLOAD " ft3,  %[fp]+3*%[f](sp);"
+                RISCV_IRQ_FLOAD " ft4,  %[fp]+4*%[f](sp);"
+                RISCV_IRQ_FLOAD " ft5,  %[fp]+5*%[f](sp);"
+                RISCV_IRQ_FLOAD " ft6,  %[fp]+6*%[f](sp);"
+                RISCV_IRQ_FLOAD " ft7,  %[fp]+7*%[f](sp);"
+                RISCV_IRQ_FLOAD " ft8,  %[fp]+8*%[f](sp);"
+                RISCV_IRQ_FLOAD " ft9,  %[fp]+9*%[f](sp);"
+                RISCV_IRQ_FLOAD " ft10, %[fp]+10*%[f](sp);"
+                RISCV_IRQ_FLOAD " ft11, %[fp]+11*%[f](sp);"
+                RISCV_IRQ_FLOAD " fa0,  %[fp]+12*%[f](sp);"
+                RISCV_IRQ_FLOAD " fa1,  %[fp]+13*%[f](sp);"
+                RISCV_IRQ_FLOAD " fa2,  %[fp]+14*%[f](sp);"
+                RISCV_IRQ_FLOAD " fa3,  %[fp]+15*%[f](sp);"
+                RISCV_IRQ_FLOAD " fa4,  %[fp]+16*%[f](sp);"
+                RISCV_IRQ_FLOAD " fa5,  %[fp]+17*%[f](sp);"
+                RISCV_IRQ_FLOAD " fa6,  %[fp]+18*%[f](sp);"
+                RISCV_IRQ_FLOAD " fa7,  %[fp]+19*%[f](sp);"
+                "lw t0, %[fp]+20*%[f](sp);"
+                "fscsr t0;"
+#endif
+                RISCV_IRQ_LOAD " ra,  0*%[x](sp);"
+                RISCV_IRQ_LOAD " t0,  1*%[x](sp);"
+                RISCV_IRQ_LOAD " t1,  2*%[x](sp);"
+                RISCV_IRQ_LOAD " t2,  3*%[x](sp);"
+                RISCV_IRQ_LOAD " a0,  4*%[x](sp);"
+                RISCV_IRQ_LOAD " a1,  5*%[x](sp);"
+                RISCV_IRQ_LOAD " a2,  6*%[x](sp);"
+                RISCV_IRQ_LOAD " a3,  7*%[x](sp);"
+                RISCV_IRQ_LOAD " a4,  8*%[x](sp);"
+                RISCV_IRQ_LOAD " a5,  9*%[x](sp);"
+                RISCV_IRQ_LOAD " a6, 10*%[x](sp);"
+                RISCV_IRQ_LOAD " a7, 11*%[x](sp);"
+                RISCV_IRQ_LOAD " t3, 12*%[x](sp);"
+                RISCV_IRQ_LOAD " t4, 13*%[x](sp);"
+                RISCV_IRQ_LOAD " t5, 14*%[x](sp);"
+                RISCV_IRQ_LOAD " t6, 15*%[x](sp);"
+                "addi sp, sp, %[frame];"
+                "mret;"
+                ".popsection;"
+                "la %[entry], .Lminimal_entry%=;"
+                : [entry] "=r"(entry)
+                : [frame] "i"(MINIMAL_ENTRY_FRAME),
+                  [x] "i"(sizeof(std::uintptr_t)),
+                  [fp] "i"(MINIMAL_ENTRY_XREGS * sizeof(std::uintptr_t)),
+                  [f] "i"(MINIMAL_ENTRY_FREG_SIZE),
+                  [handler] "i"(&minimal_handler::_execute_handler)
+                : /* clobbers: none */);
+            return entry;
+        }
+
+#undef RISCV_IRQ_STORE
+#undef RISCV_IRQ_LOAD
+#undef RISCV_IRQ_FSTORE
+#undef RISCV_IRQ_FLOAD
+    }// namespace irq
+
+    // Vectored mode IRQ handling, mtvec.MODE=1
+    namespace irq {
+
+        /** Number of entries in the vector table.
+            Covers the machine mode software, timer and external interrupts. */
+        static constexpr std::uint32_t VECTOR_TABLE_SIZE = 12;
+        /** mtvec.MODE value for vectored interrupts */
+        static constexpr std::uintptr_t MTVEC_MODE_VECTORED = 1;
+
+        /** Bind a function object to an interrupt cause (riscv::interrupts).
+            Used to build a vectored_handler.
+        */
+        template<std::uint32_t CAUSE, class T>
+        struct vector {
+            static_assert(CAUSE > 0 && CAUSE < VECTOR_TABLE_SIZE, "Interrupt cause is not in the vector table");
+            static constexpr std::uint32_t cause = CAUSE;
+            using handler_type = T;
+            T const& handler;
+        };
+
+        /** Create a vector entry binding isr_handler to an interrupt cause.
+         */
+        template<std::uint32_t CAUSE, class T>
+        vector<CAUSE, T> make_vector(T const& isr_handler) {
+            return { isr_handler };
+        }
+
+        /** Find the vector for a given cause. The type is void when no vector is bound to the cause. */
+        template<std::uint32_t CAUSE, class... VECTORS>
+        struct find_vector {
+            using type = void;
+        };
+        template<std::uint32_t CAUSE, class VECTOR, class... VECTORS>
+        struct find_vector<CAUSE, VECTOR, VECTORS...> {
+            using type = std::conditional_t<VECTOR::cause == CAUSE,
+                                            VECTOR,
+                                            typename find_vector<CAUSE, VECTORS...>::type>;
+        };
+
+        /** Context (function object) for each vector. */
+        template<class VECTOR>
+        inline typename VECTOR::handler_type const* vector_context{ nullptr };
+
+        /** Interrupt entry point for one vector.
+            This is jumped to directly from the vector table, so there is no mcause decode
+            and the function object is called directly.
+            When no vector is bound (VECTOR is void) this simply returns.
+        */
+        template<class VECTOR>
+        static void vector_entry(void) __attribute__((interrupt("machine")));
+
+        /** Emit the vector table and return its address. Each entry is a jump to the vector entry for that cause.
+            Entry 0 is also used for all exceptions.
+         */
+        template<class... VECTORS>
+        static std::uintptr_t vector_table(void);
+
+        /** IRQ Handler class. Installs a vector table with one entry per interrupt cause.
+            The table is generated at compile time from the vector types.
+
+            e.g.
+            riscv::irq::vectored_handler irq_handler(riscv::irq::make_vector<riscv::interrupts::mti>(mti_handler),
+                                                     riscv::irq::make_vector<riscv::interrupts::mei>(mei_handler));
+        */
+        template<class... VECTORS>
+        class vectored_handler {
+          public:
+            /** Create an IRQ handler class to install the function objects
+                as vectored machine mode irq handlers */
+            explicit vectored_handler(VECTORS const&... vectors) {
+                // Save the context for each vector entry.
+                ((vector_context<VECTORS> = &vectors.handler), ...);
+                // Write the vector table to the mtvec register and enable vectored mode.
+                riscv::csrs.mtvec.write(vector_table<VECTORS...>() | MTVEC_MODE_VECTORED);
+            }
+
+            // Boilerplate delete defaults - non copyable class
+            vectored_handler(const vectored_handler&) = delete;
+            vectored_handler& operator=(const vectored_handler&) = delete;
+            vectored_handler(vectored_handler&&) = delete;
+            vectored_handler& operator=(vectored_handler&&) = delete;
+        };
+
+        template<class VECTOR>
+        static void vector_entry(void) {
+            if constexpr (!std::is_void_v<VECTOR>) {
+                TRACE_EVENT(isr_enter, VECTOR::cause);
+                // Call into the lambda function.
+                vector_context<VECTOR>->operator()();
+                TRACE_EVENT(isr_exit, VECTOR::cause);
+            }
+        }
+
+        template<class... VECTORS>
+        static std::uintptr_t vector_table(void) {
+            std::uintptr_t table;
+            // Extended asm is not allowed in a naked function, so the table is emitted from this function
+            // into its own section, aligned for mtvec.BASE.
+            // Each entry must be a 4 byte instruction, so compressed instructions are disabled.
+            __asm__(
+                ".pushsection .text.riscv_irq_vector_table,\"ax\",@progbits;"
+                ".balign 64;"
+                ".Lvector_table%=:"
+                ".option push;"
+                ".option norvc;"
+                "j %1;"
+                "j %2;"
+                "j %3;"
+                "j %4;"
+                "j %5;"
+                "j %6;"
+                "j %7;"
+                "j %8;"
+                "j %9;"
+                "j %10;"
+                "j %11;"
+                "j %12;"
+                ".option pop;"
+                ".popsection;"
+                "la %0, .Lvector_table%=;"
+                : "=r"(table)
+                : "i"(&vector_entry<typename find_vector<0, VECTORS...>::type>),
+                  "i"(&vector_entry<typename find_vector<1, VECTORS...>::type>),
+                  "i"(&vector_entry<typename find_vector<2, VECTORS...>::type>),
+                  "i"(&vector_entry<typename find_vector<3, VECTORS...>::type>),
+                  "i"(&vector_entry<typename find_vector<4, VECTORS...>::type>),
+                  "i"(&vector_entry<typename find_vector<5, VECTORS...>::type>),
+                  "i"(&vector_entry<typename find_vector<6, VECTORS...>::type>),
+                  "i"(&vector_entry<typename find_vector<7, VECTORS...>::type>),
+                  "i"(&vector_entry<typename find_vector<8, VECTORS...>::type>),
+                  "i"(&vector_entry<typename find_vector<9, VECTORS...>::type>),
+                  "i"(&vector_entry<typename find_vector<10, VECTORS...>::type>),
+                  "i"(&vector_entry<typename find_vector<11, VECTORS...>::type>)
+                : /* clobbers: none */);
+            return table;
+        }
+        static_assert(VECTOR_TABLE_SIZE == 12, "vector_table() has one jump per entry");
+    }// namespace irq
+
 }// namespace riscv
 
 
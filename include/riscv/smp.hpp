@@ -0,0 +1,103 @@
+/*
+   Multi-hart (SMP) support, hart identity and secondary hart release.
+
+   _enter in startup.cpp gives each hart a stack and sets tp to the mhartid,
+   the secondary harts wait until they are released by the boot hart.
+
+   SPDX-License-Identifier: Unlicense
+
+   https://five-embeddev.com/
+
+*/
+
+#ifndef SMP_HPP
+#define SMP_HPP
+
+#include <cstddef>
+#include <cstdint>
+
+#include "riscv-csr.hpp"
+#include "msip.hpp"
+
+// Defined in the linker script, the address is the number of harts started by _enter.
+extern "C" char __num_harts[];
+// Defined in startup.cpp
+extern "C" void _release_secondary(void (*entry)(std::size_t));
+
+namespace riscv {
+
+    namespace smp {
+
+        /** Entry point of a secondary hart, called with the hart id. */
+        using hart_entry_t = void (*)(std::size_t);
+
+        /** Id of the calling hart, tp is set to mhartid by _enter.
+         */
+        inline std::size_t hart_id(void) {
+            std::size_t id;
+            __asm__ volatile("mv %0, tp"
+                             : "=r"(id));
+            return id;
+        }
+
+        /** Number of harts started by _enter, set by __num_harts in the linker script.
+         */
+        inline std::size_t hart_count(void) {
+            return reinterpret_cast<std::uintptr_t>(__num_harts);
+        }
+
+        /** Send an inter-processor interrupt, raise the machine software interrupt of a hart.
+         */
+        inline void send_ipi(std::size_t hart) {
+            driver::msip<>{ hart }.set();
+        }
+
+        /** Block the calling hart in wfi until it receives an inter-processor interrupt, then clear it.
+            Also returns when the timer of the hart expires, if the timer interrupt is enabled (mie.mti).
+            The interrupt is latched in msip, so an IPI sent before the wait is not lost.
+            Called with interrupts disabled (mstatus.mie), as the msip handler is not used.
+         */
+        inline void wait_ipi(void) {
+            driver::msip<> msip{ hart_id() };
+            riscv::csrs.mie.msi.set();
+            while (!msip.pending() && !(riscv::csrs.mie.mti.read() && riscv::csrs.mip.mti.read())) {
+                __asm__ volatile("wfi");
+            }
+            msip.clear();
+        }
+
+        /** Hart identity and wakeup for the SMP executor.
+         */
+        struct this_hart {
+            static std::size_t id(void) {
+                return hart_id();
+            }
+            static void wake(std::size_t hart) {
+                send_ipi(hart);
+            }
+            static void wait(void) {
+                wait_ipi();
+            }
+        };
+
+        /** Release the secondary harts waiting in _enter, each calls entry(hart_id).
+            Called once by the boot hart. The harts never return, so there is nothing to join.
+         */
+        class secondary_harts {
+          public:
+            explicit secondary_harts(hart_entry_t entry) {
+                _release_secondary(entry);
+            }
+
+            // Boilerplate delete defaults - non copyable class
+            secondary_harts(const secondary_harts&) = delete;
+            secondary_harts& operator=(const secondary_harts&) = delete;
+            secondary_harts(secondary_harts&&) = delete;
+            secondary_harts& operator=(secondary_harts&&) = delete;
+        };
+
+    }// namespace smp
+
+}// namespace riscv
+
+#endif// SMP_HPP
@@ -9,6 +9,7 @@
 #ifndef TIMER_HPP
 #define TIMER_HPP
 
+#include <cstddef>
 #include <cstdint>
 #include <chrono>
 
@@ -31,10 +32,12 @@ namespace driver {
     /** Default definintion of a the memory mapped mtimer CSR registers.
     The RISC-V spec does not specify and address, so they may be mapped to any address location.
     The addresses here are from freedom-e-sdk/bsp/sifive-hifive1-revb/design.svd
+    There is one mtimecmp per hart (CLINT/ACLINT layout), and one mtime shared by all harts.
     / /
     */
     struct mtimer_address_spec {
         static constexpr std::uintptr_t MTIMECMP_ADDR = 0x2000000 + 0x4000;
+        static constexpr std::uintptr_t MTIMECMP_HART_STRIDE = 8;
         static constexpr std::uintptr_t MTIME_ADDR = 0x2000000 + 0xBFF8;
     };
 
@@ -48,6 +51,11 @@ namespace driver {
         /** Duration of each timer tick */
         using timer_ticks = std::chrono::duration<int, std::ratio<1, CONFIG::MTIME_FREQ_HZ>>;
 
+        /** @param hart The hart (mhartid) that owns the timer compare register. */
+        explicit timer(std::size_t hart = 0)
+            : mtimecmp_addr_{ ADDRESS_SPEC::MTIMECMP_ADDR + hart * ADDRESS_SPEC::MTIMECMP_HART_STRIDE } {
+        }
+
 
         /** Set the timer compare point using a std::chrono::duration timer offset
          */
@@ -84,12 +92,12 @@ namespace driver {
             auto new_mtimecmp = get_raw_time() + clock_offset;
             if constexpr (__riscv_xlen == 64) {
                 // Single bus access
-                auto mtimecmp = reinterpret_cast<volatile std::uint64_t*>(ADDRESS_SPEC::MTIMECMP_ADDR);
+                auto mtimecmp = reinterpret_cast<volatile std::uint64_t*>(mtimecmp_addr_);
                 *mtimecmp = new_mtimecmp;
             }
             else {
-                auto mtimecmpl = reinterpret_cast<volatile std::uint32_t*>(ADDRESS_SPEC::MTIMECMP_ADDR);
-                auto mtimecmph = reinterpret_cast<volatile std::uint32_t*>(ADDRESS_SPEC::MTIMECMP_ADDR + 4);
+                auto mtimecmpl = reinterpret_cast<volatile std::uint32_t*>(mtimecmp_addr_);
+                auto mtimecmph = reinterpret_cast<volatile std::uint32_t*>(mtimecmp_addr_ + 4);
                 // AS we are doing 32 bit writes, an intermediate mtimecmp value may cause spurious interrupts.
                 // Prevent that by first setting the dummy MSB to an unacheivable value
                 *mtimecmph = 0xFFFFFFFF;// cppcheck-suppress redundantAssignment
@@ -123,6 +131,8 @@ namespace driver {
                 return (static_cast<std::uint64_t>(mtimeh_val) << 32) | mtimel_val;
             }
         }
+
+        const std::uintptr_t mtimecmp_addr_;
     };
 
 }// namespace driver
@@ -0,0 +1,117 @@
+#!/usr/bin/env python3
+"""Map PC samples (include/debug/pc_sampler.hpp) to the symbols of main.elf.
+
+With --spike the ELF is run on Spike until pc_sample_done() and pc_sample_log
+is read from memory, no debugger is needed. Otherwise the input is a binary
+dump of pc_sample_log.
+
+Prints the functions with the most samples.
+"""
+
+import argparse
+import bisect
+import re
+import struct
+import subprocess
+import sys
+
+from run_cycle_benchmarks import SPIKE_MMAP, SPIKE_PC
+
+MAGIC = 0x31435053
+HEADER = struct.Struct("<6I")
+
+
+def read_samples(raw):
+    """Return ({pc: count}, samples, dropped)."""
+    magic, pc_bytes, entries, samples, dropped, _ = HEADER.unpack_from(raw)
+    if magic != MAGIC:
+        raise ValueError("not a PC sample dump, magic is 0x%08x" % magic)
+    entry = struct.Struct("<II" if pc_bytes == 4 else "<QQ")
+    counts = {}
+    for i in range(entries):
+        pc, count = entry.unpack_from(raw, HEADER.size + i * entry.size)
+        if count:
+            counts[pc] = count
+    return counts, samples, dropped
+
+
+def symbol(elf, nm, name):
+    """Return the address and size of a symbol in the ELF file."""
+    output = subprocess.run([nm, "-S", "--defined-only", elf], check=True, capture_output=True, text=True).stdout
+    for line in output.splitlines():
+        fields = line.split()
+        if len(fields) == 4 and fields[3] == name:
+            return int(fields[0], 16), int(fields[1], 16)
+    raise ValueError("%s not found in %s" % (name, elf))
+
+
+def run_spike(args):
+    """Run the ELF on Spike until pc_sample_done(), return pc_sample_log."""
+    done, _ = symbol(args.elf, args.nm, "pc_sample_done")
+    table, size = symbol(args.elf, args.nm, "pc_sample_log")
+    # mem reads 64 bits at 8 byte aligned addresses, the table is aligned.
+    commands = ["until pc 0 0x%x" % done]
+    commands += ["mem 0 0x%x" % (table + offset) for offset in range(0, size, 8)]
+    commands += ["q"]
+    result = subprocess.run([args.spike, "-d", "--isa=%s" % args.isa, "--priv=m",
+                             "-m%s" % SPIKE_MMAP, "--pc=%s" % SPIKE_PC, args.elf],
+                            input="\n".join(commands) + "\n",
+                            capture_output=True, text=True, timeout=args.timeout)
+    words = re.findall(r"^0x([0-9a-fA-F]{16})$", result.stdout + result.stderr, re.MULTILINE)
+    if len(words) != (size + 7) // 8:
+        raise RuntimeError("spike did not reach pc_sample_done:\n%s" % result.stderr)
+    return b"".join(struct.pack("<Q", int(word, 16)) for word in words)
+
+
+def read_symbols(elf, nm):
+    """Return sorted lists of (address, name) for the code symbols in the ELF file."""
+    output = subprocess.run([nm, "-n", "-C", "--defined-only", elf],
+                            check=True, capture_output=True, text=True).stdout
+    addresses = []
+    names = []
+    for line in output.splitlines():
+        fields = line.split(" ", 2)
+        if len(fields) == 3 and fields[1] in "tTwW":
+            addresses.append(int(fields[0], 16))
+            names.append(fields[2])
+    return addresses, names
+
+
+def main():
+    parser = argparse.ArgumentParser(description=__doc__, formatter_class=argparse.RawDescriptionHelpFormatter)
+    parser.add_argument("elf", help="program that was sampled, e.g. build_target/src/main.elf")
+    parser.add_argument("dump", nargs="?", help="binary dump of pc_sample_log, not used with --spike")
+    parser.add_argument("--nm", default="riscv-none-elf-nm", help="nm for the target (default %(default)s)")
+    parser.add_argument("--spike", help="run the ELF on this Spike and read the samples from memory")
+    parser.add_argument("--isa", default="rv32imac_zicsr", help="Spike --isa (default %(default)s)")
+    parser.add_argument("--timeout", type=int, default=120, help="seconds for the Spike run")
+    parser.add_argument("--top", type=int, default=20, help="number of functions to print")
+    parser.add_argument("--pc", action="store_true", help="print the top PCs instead of functions")
+    args = parser.parse_args()
+    if not args.spike and not args.dump:
+        parser.error("a dump file or --spike is needed")
+
+    if args.spike:
+        raw = run_spike(args)
+    else:
+        with open(args.dump, "rb") as f:
+            raw = f.read()
+    counts, samples, dropped = read_samples(raw)
+    addresses, names = read_symbols(args.elf, args.nm)
+
+    totals = {}
+    for pc, count in counts.items():
+        i = bisect.bisect_right(addresses, pc) - 1
+        name = names[i] if i >= 0 else "??"
+        key = "0x%08x %s" % (pc, name) if args.pc else name
+        totals[key] = totals.get(key, 0) + count
+
+    print("samples=%d dropped=%d" % (samples, dropped))
+    recorded = sum(totals.values()) or 1
+    for key, count in sorted(totals.items(), key=lambda item: -item[1])[:args.top]:
+        print("%6.2f%% %8d  %s" % (100.0 * count / recorded, count, key))
+    return 0
+
+
+if __name__ == "__main__":
+    sys.exit(main())
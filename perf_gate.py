@@ -0,0 +1,191 @@
+#!/usr/bin/env python3
+"""Compare code size and cycle benchmarks against a committed baseline.
+
+Metrics:
+
+- section/<elf>/<kind>         Size of all text, rodata, data or bss sections of an ELF file.
+- size/<elf>/<kind>/<symbol>   Size of a co-routine runtime symbol, e.g. the scheduler_ordered,
+                               static_list and nop_task instantiations. --pattern is matched
+                               against the qualified name, not the return type or parameters.
+- size/<elf>/<kind>/runtime    Total size of the runtime symbols.
+- cycles/<isa>/<benchmark>     Cycles per operation from cycle_benchmarks_<isa>.csv (run_cycle_benchmarks.py).
+- instret/<isa>/<benchmark>    Instructions per operation.
+
+Fails (exit 1) when a metric is more than threshold_percent above the
+baseline, when a baseline metric is missing from the current run, or when
+the baseline has no metrics (unless --allow-empty-baseline). Metrics that
+are not in the baseline are listed but don't fail, --update writes the
+current metrics as the new baseline.
+"""
+
+import argparse
+import csv
+import json
+import os
+import re
+import subprocess
+import sys
+
+# Matched at the start of the qualified name, so functions that only take a runtime type as a parameter don't count.
+DEFAULT_PATTERN = r"^(scheduler_ordered|scheduler_unordered|schedule_by_\w+|schedule_entry|static_list|nop_task\w*)\b[<:]"
+DEFAULT_THRESHOLD = 5.0
+
+# objdump -t: address, 7 flag characters, section, size, name
+SYMBOL = re.compile(r"^([0-9a-fA-F]+) .{7} (\S+)\t([0-9a-fA-F]+) +(.*)$")
+# objdump -h: index, name, size, vma, lma, file offset, alignment
+SECTION = re.compile(r"^ *\d+ +(\S+) +([0-9a-fA-F]+) ")
+
+
+def section_kind(section):
+    """Map a section name to text, rodata, data or bss. None if it isn't loaded."""
+    for kind, prefixes in (("text", (".text", ".init", ".fini", ".itim")),
+                           ("rodata", (".rodata", ".srodata", ".eh_frame", ".gcc_except_table")),
+                           ("data", (".data", ".sdata", ".tdata", ".init_array", ".fini_array")),
+                           ("bss", (".bss", ".sbss", ".tbss", "*COM*"))):
+        if section.startswith(prefixes):
+            return kind
+    return None
+
+
+def qualified_name(symbol):
+    """Return the qualified name of a demangled symbol, without the return type and parameters."""
+    depth = 0
+    start = 0
+    i = 0
+    while i < len(symbol):
+        if symbol.startswith("(anonymous namespace)", i):
+            i += len("(anonymous namespace)")
+            continue
+        c = symbol[i]
+        if c == "<":
+            depth += 1
+        elif c == ">":
+            depth -= 1
+        elif depth == 0 and c == "(":
+            return symbol[start:i]
+        elif depth == 0 and c == " ":
+            start = i + 1
+        i += 1
+    return symbol[start:]
+
+
+def objdump(args, option, elf):
+    return subprocess.run([args.objdump, option, "-C", elf], check=True, capture_output=True, text=True).stdout
+
+
+def size_metrics(args, elf, pattern):
+    """Return the section and runtime symbol size metrics of an ELF file."""
+    name = os.path.basename(elf)
+    metrics = {}
+    for line in objdump(args, "-h", elf).splitlines():
+        match = SECTION.match(line)
+        kind = match and section_kind(match.group(1))
+        if kind:
+            key = "section/%s/%s" % (name, kind)
+            metrics[key] = metrics.get(key, 0) + int(match.group(2), 16)
+    for line in objdump(args, "-t", elf).splitlines():
+        match = SYMBOL.match(line)
+        if not match or not pattern.search(qualified_name(match.group(4))):
+            continue
+        kind = section_kind(match.group(2))
+        size = int(match.group(3), 16)
+        if not kind or not size:
+            continue
+        # Symbols with the same name (e.g. static functions) are summed.
+        for key in ("size/%s/%s/%s" % (name, kind, match.group(4)), "size/%s/%s/runtime" % (name, kind)):
+            metrics[key] = metrics.get(key, 0) + size
+    return metrics
+
+
+def cycle_metrics(path):
+    """Return the cycle and instruction metrics of a run_cycle_benchmarks.py CSV file."""
+    metrics = {}
+    with open(path, newline="") as f:
+        for row in csv.DictReader(f):
+            metrics["cycles/%s/%s" % (row["isa"], row["benchmark"])] = float(row["cycles_per_op"])
+            metrics["instret/%s/%s" % (row["isa"], row["benchmark"])] = float(row["instret_per_op"])
+    return metrics
+
+
+def compare(baseline, current, threshold):
+    """Return the lists of (key, base, value) that regressed, improved, are new and are missing."""
+    regressed, improved, new = [], [], []
+    missing = [(key, base, None) for key, base in sorted(baseline.items()) if key not in current]
+    for key, value in sorted(current.items()):
+        if key not in baseline:
+            new.append((key, None, value))
+            continue
+        base = baseline[key]
+        if value > base * (1.0 + threshold / 100.0):
+            regressed.append((key, base, value))
+        elif value < base:
+            improved.append((key, base, value))
+    return regressed, improved, new, missing
+
+
+def print_changes(title, changes):
+    if not changes:
+        return
+    print("%s:" % title)
+    for key, base, value in changes:
+        if base is None:
+            print("  %-80s %12g" % (key, value))
+        elif value is None:
+            print("  %-80s %12g -> missing" % (key, base))
+        else:
+            change = 100.0 * (value - base) / base if base else float("inf")
+            print("  %-80s %12g -> %-12g %+.1f%%" % (key, base, value, change))
+
+
+def main():
+    parser = argparse.ArgumentParser(description=__doc__, formatter_class=argparse.RawDescriptionHelpFormatter)
+    parser.add_argument("--baseline", default="perf_baseline.json", help="baseline file (default %(default)s)")
+    parser.add_argument("--elf", action="append", default=[], help="ELF file to measure, can be repeated")
+    parser.add_argument("--cycles", action="append", default=[], help="cycle benchmark CSV file, can be repeated")
+    parser.add_argument("--objdump", default="riscv-none-elf-objdump", help="objdump for the target (default %(default)s)")
+    parser.add_argument("--pattern", default=DEFAULT_PATTERN, help="regex of the runtime symbols (default %(default)s)")
+    parser.add_argument("--threshold", type=float, help="allowed increase in percent (default from the baseline, or %g)" % DEFAULT_THRESHOLD)
+    parser.add_argument("--update", action="store_true", help="write the current metrics to the baseline")
+    parser.add_argument("--allow-empty-baseline", action="store_true",
+                        help="pass when the baseline has no metrics, e.g. before it is first recorded")
+    args = parser.parse_args()
+
+    pattern = re.compile(args.pattern)
+    current = {}
+    for elf in args.elf:
+        current.update(size_metrics(args, elf, pattern))
+    for path in args.cycles:
+        current.update(cycle_metrics(path))
+
+    baseline = {}
+    if os.path.exists(args.baseline):
+        with open(args.baseline) as f:
+            baseline = json.load(f)
+    threshold = args.threshold if args.threshold is not None else baseline.get("threshold_percent", DEFAULT_THRESHOLD)
+
+    if args.update:
+        baseline["threshold_percent"] = threshold
+        baseline["metrics"] = current
+        with open(args.baseline, "w") as f:
+            json.dump(baseline, f, indent=2, sort_keys=True)
+            f.write("\n")
+        print("%s: %d metrics" % (args.baseline, len(current)))
+        return 0
+
+    metrics = baseline.get("metrics", {})
+    regressed, improved, new, missing = compare(metrics, current, threshold)
+    print_changes("Improved", improved)
+    print_changes("Not in the baseline", new)
+    print_changes("Missing from this run", missing)
+    print_changes("Regressed more than %g%%" % threshold, regressed)
+    print("%d metrics, %d regressed, %d improved, %d not in the baseline, %d missing" %
+          (len(current), len(regressed), len(improved), len(new), len(missing)))
+    if not metrics and not args.allow_empty_baseline:
+        print("%s has no metrics, record it with --update (make perf_baseline) or pass --allow-empty-baseline" %
+              args.baseline)
+        return 1
+    return 1 if regressed or missing else 0
+
+
+if __name__ == "__main__":
+    sys.exit(main())
@@ -0,0 +1,168 @@
+#!/usr/bin/env python3
+"""Build and run the cycle benchmarks (bench/cycle_benchmarks.cpp) on Spike or QEMU.
+
+For each ISA the target is configured with -DRISCV_ARCH=<isa> in
+build_bench_<isa>, cycle_benchmarks.elf is run headless until bench_done()
+and the cycle_bench_log table is read back:
+
+- Spike runs in debug mode (-d), "until pc" stops at bench_done and "mem" reads the table.
+- QEMU runs with -icount so mcycle is deterministic, GDB stops at bench_done and dumps the table.
+  QEMU's sifive_e machine only models rv32imac, use Spike for the other ISAs.
+
+The results are written to cycle_benchmarks_<isa>.csv. Simulator cycles are
+a model of the core, they are for comparing builds, not hardware timing.
+"""
+
+import argparse
+import csv
+import os
+import re
+import socket
+import struct
+import subprocess
+import sys
+import tempfile
+
+MAGIC = 0x31594342
+HEADER = struct.Struct("<2I")
+RESULT = struct.Struct("<2I2Q")
+ENTRIES = 8
+TABLE_SIZE = HEADER.size + ENTRIES * RESULT.size
+
+# Benchmark identifiers, the enum cycle_bench in bench/cycle_benchmarks.cpp
+BENCHMARKS = {
+    1: "context_switch",
+    2: "timer_insert",
+    3: "isr_round_trip",
+    4: "channel_ping_pong",
+}
+
+DEFAULT_ISAS = ["rv32imac_zicsr", "rv32gc", "rv64gc"]
+
+# Memory map of src/linker.lds, the CLINT is Spike's default.
+SPIKE_MMAP = "0x8000000:0x2000,0x80000000:0x4000,0x20010000:0x6a120"
+SPIKE_PC = "0x20010000"
+
+
+def read_table(raw):
+    """Return a list of (name, iterations, cycles, instret)."""
+    magic, count = HEADER.unpack_from(raw)
+    if magic != MAGIC:
+        raise ValueError("not a cycle benchmark table, magic is 0x%08x" % magic)
+    results = []
+    for i in range(min(count, ENTRIES)):
+        ident, iterations, cycles, instret = RESULT.unpack_from(raw, HEADER.size + i * RESULT.size)
+        results.append((BENCHMARKS.get(ident, "unknown_%u" % ident), iterations, cycles, instret))
+    return results
+
+
+def symbol(elf, nm, name):
+    """Return the address of a symbol in the ELF file."""
+    output = subprocess.run([nm, "--defined-only", elf], check=True, capture_output=True, text=True).stdout
+    for line in output.splitlines():
+        fields = line.split()
+        if len(fields) == 3 and fields[2] == name:
+            return int(fields[0], 16)
+    raise ValueError("%s not found in %s" % (name, elf))
+
+
+def build(args, isa):
+    """Configure and build the target for an ISA, return the path of the ELF file."""
+    build_dir = "%s%s" % (args.build_prefix, isa)
+    subprocess.run(["cmake",
+                    "-DCMAKE_TOOLCHAIN_FILE=%s" % os.path.abspath("cmake/riscv.cmake"),
+                    "-DRISCV_ARCH=%s" % isa,
+                    "-B", build_dir, "-S", "."], check=True)
+    subprocess.run(["cmake", "--build", build_dir, "--target", "cycle_benchmarks.elf"], check=True)
+    return os.path.join(build_dir, "bench", "cycle_benchmarks.elf")
+
+
+def run_spike(args, isa, elf):
+    """Run on Spike, return the table."""
+    done = symbol(elf, args.nm, "bench_done")
+    table = symbol(elf, args.nm, "cycle_bench_log")
+    # mem reads 64 bits at 8 byte aligned addresses.
+    commands = ["until pc 0 0x%x" % done]
+    commands += ["mem 0 0x%x" % (table + offset) for offset in range(0, TABLE_SIZE, 8)]
+    commands += ["q"]
+    result = subprocess.run([args.spike, "-d", "--isa=%s" % isa, "--priv=m",
+                             "-m%s" % SPIKE_MMAP, "--pc=%s" % SPIKE_PC, elf],
+                            input="\n".join(commands) + "\n",
+                            capture_output=True, text=True, timeout=args.timeout)
+    words = re.findall(r"^0x([0-9a-fA-F]{16})$", result.stdout + result.stderr, re.MULTILINE)
+    if len(words) != TABLE_SIZE // 8:
+        raise RuntimeError("spike did not reach bench_done:\n%s" % result.stderr)
+    return b"".join(struct.pack("<Q", int(word, 16)) for word in words)
+
+
+def free_port():
+    with socket.socket() as s:
+        s.bind(("localhost", 0))
+        return s.getsockname()[1]
+
+
+def run_qemu(args, isa, elf):
+    """Run on QEMU sifive_e, return the table."""
+    if not isa.startswith("rv32imac"):
+        raise RuntimeError("QEMU sifive_e only models rv32imac, use --sim spike for %s" % isa)
+    port = free_port()
+    qemu = subprocess.Popen([args.qemu, "-nographic", "-machine", "sifive_e",
+                             "-icount", "shift=0", "-kernel", elf,
+                             "-gdb", "tcp::%d" % port, "-S"],
+                            stdout=subprocess.DEVNULL, stderr=subprocess.DEVNULL)
+    try:
+        with tempfile.TemporaryDirectory() as tmp:
+            dump = os.path.join(tmp, "cycle_bench_log.bin")
+            subprocess.run([args.gdb, "-batch",
+                            "-ex", "target remote :%d" % port,
+                            "-ex", "break bench_done",
+                            "-ex", "continue",
+                            "-ex", "dump binary value %s cycle_bench_log" % dump,
+                            elf], check=True, capture_output=True, timeout=args.timeout)
+            with open(dump, "rb") as f:
+                return f.read()
+    finally:
+        qemu.kill()
+        qemu.wait()
+
+
+def write_csv(path, isa, results):
+    with open(path, "w", newline="") as f:
+        out = csv.writer(f)
+        out.writerow(["isa", "benchmark", "iterations", "cycles", "instret", "cycles_per_op", "instret_per_op"])
+        for name, iterations, cycles, instret in results:
+            out.writerow([isa, name, iterations, cycles, instret,
+                          "%.1f" % (cycles / iterations), "%.1f" % (instret / iterations)])
+
+
+def main():
+    parser = argparse.ArgumentParser(description=__doc__, formatter_class=argparse.RawDescriptionHelpFormatter)
+    parser.add_argument("--sim", choices=["spike", "qemu"], default="spike", help="simulator (default %(default)s)")
+    parser.add_argument("--isa", nargs="+", default=DEFAULT_ISAS, help="ISAs to run (default %(default)s)")
+    parser.add_argument("--build-prefix", default="build_bench_", help="build directory prefix (default %(default)s)")
+    parser.add_argument("--elf", help="run this ELF file instead of building, with a single --isa")
+    parser.add_argument("--output-dir", default=".", help="directory of the CSV files")
+    parser.add_argument("--spike", default="spike")
+    parser.add_argument("--qemu", default="qemu-system-riscv32")
+    parser.add_argument("--gdb", default="riscv-none-elf-gdb")
+    parser.add_argument("--nm", default="riscv-none-elf-nm")
+    parser.add_argument("--timeout", type=int, default=120, help="seconds per simulator run")
+    args = parser.parse_args()
+
+    if args.elf and len(args.isa) != 1:
+        parser.error("--elf needs a single --isa")
+
+    for isa in args.isa:
+        elf = args.elf or build(args, isa)
+        raw = run_spike(args, isa, elf) if args.sim == "spike" else run_qemu(args, isa, elf)
+        results = read_table(raw)
+        path = os.path.join(args.output_dir, "cycle_benchmarks_%s.csv" % isa)
+        write_csv(path, isa, results)
+        print("%s: %s" % (isa, path))
+        for name, iterations, cycles, instret in results:
+            print("  %-20s %10.1f cycles/op %10.1f instret/op" % (name, cycles / iterations, instret / iterations))
+    return 0
+
+
+if __name__ == "__main__":
+    sys.exit(main())
@@ -20,6 +20,17 @@ static volatile uint32_t resume_main_t5{ 0 };
 static volatile uint32_t resume_isr_t3{ 0 };
 static volatile uint32_t resume_isr_t4{ 0 };
 static volatile uint32_t resume_isr_t5{ 0 };
+static volatile uint32_t resume_events_mti{ 0 };
+static volatile uint32_t resume_events_mei{ 0 };
+
+/** Event bits for the interrupt causes handled in this example */
+static constexpr event_mask_t EVENT_MTI = event_mask_t{ 1 } << riscv::interrupts::mti;
+static constexpr event_mask_t EVENT_MEI = event_mask_t{ 1 } << riscv::interrupts::mei;
+
+/** Resume co-routines waiting on the timer in the ISR (low latency) */
+static constexpr isr_resume MTI_RESUME = isr_resume::immediate;
+/** Defer co-routines waiting on the external interrupt to the main loop (short ISR) */
+static constexpr isr_resume MEI_RESUME = isr_resume::deferred;
 
 /**  A simple task to schedule in ISR and main thread
  * @param isr_scheduler     The actual of scheduler that will manage this co-routine's execution.
@@ -33,6 +44,7 @@ nop_task resuming_on_isr_and_main(
     MAIN_SCHEDULER& main_scheduler,
     volatile uint32_t& isr_resume_count,
     volatile uint32_t& main_resume_count) {
+    co_await task_account_name{ "isr_and_main" };
     uint32_t i{ 0 };
     while (true) {
         i++;
@@ -43,6 +55,28 @@ nop_task resuming_on_isr_and_main(
     }
 }
 
+/**  A single task that handles multiple interrupt sources via an event group.
+ * @param events         The event group set by the ISR.
+ * @param mti_count      Count the number of timer events handled. For introspection only.
+ * @param mei_count      Count the number of external events handled. For introspection only.
+ */
+template<typename EVENT_GROUP>
+nop_task resuming_on_events(
+    EVENT_GROUP& events,
+    volatile uint32_t& mti_count,
+    volatile uint32_t& mei_count) {
+    co_await task_account_name{ "events" };
+    while (true) {
+        auto set_events = co_await events.wait_any(EVENT_MTI | EVENT_MEI);
+        if (set_events & EVENT_MTI) {
+            mti_count = mti_count + 1;
+        }
+        if (set_events & EVENT_MEI) {
+            mei_count = mei_count + 1;
+        }
+    }
+}
+
 void example_irq(riscv_cpu_t& core) {
     // Timer driver
     driver::timer<> mtimer;
@@ -54,38 +88,48 @@ void example_irq(riscv_cpu_t& core) {
     // Timer will fire immediately
     mtimer.set_time_cmp(mtimer_clock::duration::zero());
 
-    scheduler_unordered<1> isr_context;
+    // Main loop, wake up at least every 100us.
+    mtimer_idle idle{ core, 100us };
+    executor<mtimer_idle<riscv_cpu_t>, mtimer_clock, 4> main_loop{ idle };
     scheduler_unordered<1> isr_mti_context;
     scheduler_unordered<1> isr_mei_context;
-    scheduler_unordered<3> main_thread;
+    event_group<1> irq_events;
 
     // Run in background, wake up on all ISRs and main
-    auto t3 = resuming_on_isr_and_main(isr_context, main_thread, resume_isr_t3, resume_main_t3);
+    auto t3 = resuming_on_isr_and_main(main_loop.isr(), main_loop.main(), resume_isr_t3, resume_main_t3);
     (void)t3;
     // Run in background, wake up on all Timer ISRs and main
-    auto t4 = resuming_on_isr_and_main(isr_mti_context, main_thread, resume_isr_t4, resume_main_t4);
+    auto t4 = resuming_on_isr_and_main(isr_mti_context, main_loop.main(), resume_isr_t4, resume_main_t4);
     (void)t4;
     // Run in background, wake up on all External ISRs and main
-    auto t5 = resuming_on_isr_and_main(isr_mei_context, main_thread, resume_isr_t5, resume_main_t5);
+    auto t5 = resuming_on_isr_and_main(isr_mei_context, main_loop.main(), resume_isr_t5, resume_main_t5);
     (void)t5;
+    // Run in background, wake up on Timer or External ISR events in main
+    auto t6 = resuming_on_events(irq_events, resume_events_mti, resume_events_mei);
+    (void)t6;
 
     // The periodic interrupt lambda function.
     // The context (drivers etc) is captured via reference using [&]
     static const auto handler = [&](void) {
-        isr_context.resume();
+        LATENCY_ISR_ENTRY(riscv::csrs.mcause.read());
+        main_loop.resume_isr();
         auto this_cause = riscv::csrs.mcause.read();
         if (this_cause & riscv::csr::mcause_data::interrupt::BIT_MASK) {
             this_cause &= 0xFF;
             // Known exceptions
             switch (this_cause) {
             case riscv::interrupts::mei:
-                isr_mei_context.resume();
+                irq_events.set(EVENT_MEI);
+                main_loop.deferred().post_resume(irq_events);
+                resume_from_isr<MEI_RESUME>(isr_mei_context, main_loop.deferred());
                 break;
             case riscv::interrupts::mti:
                 timestamp_irq = mtimer.get_time<driver::timer<>::timer_ticks>().count();
                 // Timer interrupt disable
                 riscv::csrs.mie.mti.clr();
-                isr_mti_context.resume();
+                irq_events.set(EVENT_MTI);
+                main_loop.deferred().post_resume(irq_events);
+                resume_from_isr<MTI_RESUME>(isr_mti_context, main_loop.deferred());
                 break;
             }
         }
@@ -93,28 +137,21 @@ void example_irq(riscv_cpu_t& core) {
         ;
     };
     // Install the above lambda function as the machine mode IRQ handler.
+#if defined(IRQ_MINIMAL_ENTRY)
+    // Minimal register save, single indirect call entry.
+    riscv::irq::minimal_handler irq_handler(handler);
+#else
     riscv::irq::handler irq_handler(handler);
+#endif
 
 
-    // Timer interrupt enable
+    // Timer and external interrupt enable
     riscv::csrs.mie.mti.set();
+    riscv::csrs.mie.mei.set();
     // Global interrupt enable
     riscv::csrs.mstatus.mie.set();
 
 
     // Busy loop
-    do {
-        // Get a delay to the next co-routine wakup
-        // Wakeup any co-routines waiting for main thread processing.
-        main_thread.resume();
-        // Next wakeup
-        mtimer.set_time_cmp(100us);
-        // Timer interrupt enable
-        riscv::csrs.mstatus.mie.clr();
-        riscv::csrs.mie.mti.set();
-        // WFI Should be called while interrupts are disabled
-        // to ensure interrupt enable and WFI is atomic.
-        core.wfi();
-        riscv::csrs.mstatus.mie.set();
-    } while (true);
+    main_loop.run();
 }
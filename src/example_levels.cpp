@@ -0,0 +1,114 @@
+/*
+   Baremetal example program with co-routines run at preemptive execution levels.
+
+   The timer interrupt pends the execution levels, the levels are run
+   from the machine software interrupt and preempt the long running
+   work in the main loop.
+
+   SPDX-License-Identifier: Unlicense
+
+   https://five-embeddev.com/
+
+*/
+
+#include <cstdint>
+
+#include "example_levels.hpp"
+
+#include "embeddev_coro.hpp"
+#include "embeddev_riscv.hpp"
+
+static volatile uint64_t timestamp_levels{ 0 };
+static volatile uint32_t resume_count_high{ 0 };
+static volatile uint32_t resume_count_low{ 0 };
+static volatile uint32_t background_count{ 0 };
+// Shared by the low level and the main loop, protected by a level ceiling lock.
+static volatile uint32_t shared_total{ 0 };
+
+/** Levels used in this example */
+static constexpr execution_level_t LEVEL_LOW = 1;
+static constexpr execution_level_t LEVEL_HIGH = 2;
+
+/**  A task bound to an execution level, resumed each time the level is pended.
+ * @param levels        The execution levels.
+ * @param level         The level this co-routine runs at.
+ * @param resume_count  Count the number of times this co-routine wakes up. For introspection only.
+ */
+template<typename LEVELS>
+nop_task resuming_on_level(
+    LEVELS& levels,
+    execution_level_t level,
+    volatile uint32_t& resume_count) {
+    while (true) {
+        co_await levels.wait(level);
+        resume_count = resume_count + 1;
+        if (level == LEVEL_LOW) {
+            shared_total = shared_total + 1;
+        }
+    }
+}
+
+void example_levels(riscv_cpu_t& core) {
+    (void)core;
+
+    // Timer driver
+    driver::timer<> mtimer;
+
+    // Global interrupt disable
+    riscv::csrs.mstatus.mie.clr();
+
+    timestamp_levels = mtimer.get_time<driver::timer<>::timer_ticks>().count();
+    // Timer will fire immediately
+    mtimer.set_time_cmp(mtimer_clock::duration::zero());
+
+    // Thread level and two preemptive levels, run from the software interrupt.
+    execution_levels<msip_level_irq, 3, 1> levels;
+
+    // Run in background, wake up on every timer interrupt
+    auto t0 = resuming_on_level(levels, LEVEL_HIGH, resume_count_high);
+    (void)t0;
+    // Run in background, wake up on every 4th timer interrupt
+    auto t1 = resuming_on_level(levels, LEVEL_LOW, resume_count_low);
+    (void)t1;
+
+    // The periodic interrupt lambda function.
+    // The context (drivers etc) is captured via reference using [&]
+    static const auto mti_handler = [&](void) {
+        LATENCY_ISR_ENTRY(riscv::interrupts::mti);
+        timestamp_levels = mtimer.get_time<driver::timer<>::timer_ticks>().count();
+        // Next wakeup
+        mtimer.set_time_cmp(100us);
+        levels.pend(LEVEL_HIGH);
+        if ((resume_count_high & 3) == 0) {
+            levels.pend(LEVEL_LOW);
+        }
+    };
+    // The software interrupt runs the pended levels.
+    static const auto msi_handler = [&](void) {
+        levels.dispatch();
+    };
+    // Install the above lambda functions as the machine mode timer and software IRQ vectors.
+    riscv::irq::vectored_handler irq_handler(riscv::irq::make_vector<riscv::interrupts::mti>(mti_handler),
+                                             riscv::irq::make_vector<riscv::interrupts::msi>(msi_handler));
+
+    // Timer and software interrupt enable
+    riscv::csrs.mie.mti.set();
+    riscv::csrs.mie.msi.set();
+    // Global interrupt enable
+    riscv::csrs.mstatus.mie.set();
+
+    // Busy loop
+    do {
+        // Wakeup any co-routines at the thread level.
+        levels.resume();
+        // Long running work, preempted by the execution levels.
+        for (uint32_t i = 0; i < 1000; i++) {
+            background_count = background_count + 1;
+        }
+        {
+            // The low level can't preempt while the lock is held, the high level can.
+            auto lock = levels.lock(LEVEL_LOW);
+            shared_total = shared_total + 1;
+        }
+    } while (true);
+}
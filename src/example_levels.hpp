@@ -0,0 +1,16 @@
+/*
+   Baremetal example program with co-routines run at preemptive execution levels.
+   SPDX-License-Identifier: Unlicense
+
+   https://five-embeddev.com/
+
+*/
+
+#ifndef EXAMPLE_LEVELS_H_
+#define EXAMPLE_LEVELS_H_
+
+#include "embeddev_riscv.hpp"
+
+void example_levels(riscv_cpu_t& core);
+
+#endif// EXAMPLE_LEVELS_H_
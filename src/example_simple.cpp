@@ -44,6 +44,7 @@ volatile uint64_t* timestamp_resume[10]{
 };
 
 volatile uint32_t resume_simple{ 0 };
+volatile uint32_t overrun_simple{ 0 };
 };
 
 /**  A simple task to schedule
@@ -58,8 +59,12 @@ nop_task periodic(
     std::chrono::microseconds period,
     volatile uint32_t& resume_count) {
     driver::timer<> mtimer;
+    // Resume within a tenth of the period, count the overruns.
+    deadline_monitor monitor{ period / 10, 0us, [](deadline_monitor&, std::chrono::microseconds) {
+                                 overrun_simple = overrun_simple + 1;
+                             } };
     for (auto i = 0; i < 10; i++) {
-        co_await scheduled_delay{ scheduler, period };
+        co_await scheduled_delay{ scheduler, period, &monitor };
         *timestamp_resume[resume_count] = mtimer.get_time<driver::timer<>::timer_ticks>().count();
         resume_count = i + 1;
     }
@@ -71,7 +76,9 @@ void example_simple(riscv_cpu_t& core) {
     // Timer driver
     driver::timer<> mtimer;
 
-    scheduler_delay<mtimer_clock> scheduler;
+    // Main loop, sleep in WFI until the next co-routine wakeup.
+    mtimer_idle idle{ core };
+    executor<mtimer_idle<riscv_cpu_t>, mtimer_clock> main_loop{ idle };
 
     // Global interrupt disable
     riscv::csrs.mstatus.mie.clr();
@@ -81,13 +88,14 @@ void example_simple(riscv_cpu_t& core) {
     mtimer.set_time_cmp(mtimer_clock::duration::zero());
 
     // Run two concurrent loops. The first loop wil run concurrently to the second loop.
-    auto t = periodic(scheduler, 1ms, resume_simple);
+    auto t = periodic(main_loop.delay(), 1ms, resume_simple);
     (void)t;
 
     // The periodic interrupt lambda function.
     // The context (drivers etc) is captured via reference using [&]
     static const auto handler = [&](void) {
         auto this_cause = riscv::csrs.mcause.read();
+        LATENCY_ISR_ENTRY(this_cause);
         if (this_cause & riscv::csr::mcause_data::interrupt::BIT_MASK) {
             this_cause &= 0xFF;
             // Known exceptions
@@ -104,21 +112,5 @@ void example_simple(riscv_cpu_t& core) {
     riscv::irq::handler irq_handler(handler);
 
     // Busy loop
-    do {
-        // Get a delay to the next co-routine wakup
-        schedule_by_delay<mtimer_clock> now;
-        timestamp_simple = mtimer.get_time<driver::timer<>::timer_ticks>().count();
-        auto [pending, next_wake] = scheduler.resume(now);
-        if (pending) {
-            // Next wakeup
-            mtimer.set_time_cmp(next_wake->delay());
-            // Timer interrupt enable
-            riscv::csrs.mstatus.mie.clr();
-            riscv::csrs.mie.mti.set();
-            // WFI Should be called while interrupts are disabled
-            // to ensure interrupt enable and WFI is atomic.
-            core.wfi();
-            riscv::csrs.mstatus.mie.set();
-        }
-    } while (true);
+    main_loop.run();
 }
@@ -0,0 +1,115 @@
+/*
+   Baremetal example program with co-routines spread over several harts.
+
+   The co-routines are created on hart 0, the secondary harts are
+   released and steal ready co-routines from the run queue of hart 0.
+   Each hart also runs a periodic co-routine from its own timer scheduler.
+
+   SPDX-License-Identifier: Unlicense
+
+   https://five-embeddev.com/
+
+*/
+
+#include <cstdint>
+#include <array>
+#include <chrono>
+
+#include "example_smp.hpp"
+
+#include "embeddev_coro.hpp"
+#include "embeddev_riscv.hpp"
+
+/** Number of harts used by this example, e.g. QEMU virt with -smp 4.
+    Harts that are not started (see __num_harts) leave their work to the other harts.
+ */
+static constexpr std::size_t EXAMPLE_HARTS = 4;
+static constexpr std::size_t EXAMPLE_TASKS = 8;
+
+using example_executor = smp_executor<riscv::smp::this_hart, EXAMPLE_HARTS, 8>;
+using example_timers = per_hart<scheduler_delay<mtimer_clock>, riscv::smp::this_hart, EXAMPLE_HARTS>;
+
+static example_executor* smp_executor_{ nullptr };
+static example_timers* hart_timers_{ nullptr };
+// Number of co-routines resumed on each hart. For introspection only.
+static volatile uint32_t resume_count_hart[EXAMPLE_HARTS]{};
+// Number of timer wakeups on each hart. For introspection only.
+static volatile uint32_t tick_count_hart[EXAMPLE_HARTS]{};
+
+/**  A task that yields to the executor after each unit of work.
+ * @param executor      The executor that runs the co-routine on any hart.
+ * @param work          Length of the work between yields.
+ */
+template<typename EXECUTOR>
+nop_task worker(EXECUTOR& executor, uint32_t work) {
+    volatile uint32_t total{ 0 };
+    while (true) {
+        for (uint32_t i = 0; i < work; i++) {
+            total = total + 1;
+        }
+        const auto hart = riscv::smp::hart_id();
+        resume_count_hart[hart] = resume_count_hart[hart] + 1;
+        co_await executor;
+    }
+}
+
+/**  A periodic task on the timer scheduler of a hart.
+ * @param scheduler     The timer scheduler of the hart.
+ * @param period        This co-routine will periodically wake up with this period.
+ * @param tick_count    Count the number of times this co-routine wakes up. For introspection only.
+ */
+template<typename SCHEDULER>
+nop_task hart_tick(SCHEDULER& scheduler,
+                   std::chrono::microseconds period,
+                   volatile uint32_t& tick_count) {
+    while (true) {
+        co_await scheduled_delay{ scheduler, period };
+        tick_count = tick_count + 1;
+    }
+}
+
+/** Run the timers and ready co-routines on this hart. */
+static void run_hart(std::size_t hart) {
+    if (hart >= EXAMPLE_HARTS) {
+        // Not used by this example
+        return;
+    }
+    // This hart's scheduler and timer compare, no other hart is woken by the timer.
+    auto& scheduler = hart_timers_->local();
+    driver::timer<> mtimer{ hart };
+    auto tick = hart_tick(scheduler, std::chrono::milliseconds(hart + 1), tick_count_hart[hart]);
+    (void)tick;
+    riscv::csrs.mie.mti.set();
+    while (true) {
+        schedule_by_delay<mtimer_clock> now;
+        auto [pending, next_wake] = scheduler.resume(now);
+        // Tasks may be pending with no timer wakeup, e.g. all due in this pass.
+        if (pending && next_wake) {
+            mtimer.set_time_cmp(next_wake->delay());
+        }
+        if (!smp_executor_->run_one(hart)) {
+            // Sleep until another hart has work, or the timer expires.
+            smp_executor_->idle();
+        }
+    }
+}
+
+void example_smp(riscv_cpu_t& core) {
+    (void)core;
+
+    example_executor executor;
+    smp_executor_ = &executor;
+    example_timers timers;
+    hart_timers_ = &timers;
+
+    // All co-routines start on hart 0
+    std::array<nop_task, EXAMPLE_TASKS> tasks;
+    for (std::size_t i = 0; i < tasks.size(); i++) {
+        tasks[i] = worker(executor, 100 * (i + 1));
+    }
+
+    // Release the other harts, they steal work from hart 0.
+    riscv::smp::secondary_harts harts(run_hart);
+
+    run_hart(riscv::smp::hart_id());
+}
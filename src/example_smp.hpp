@@ -0,0 +1,16 @@
+/*
+   Baremetal example program with co-routines spread over several harts.
+   SPDX-License-Identifier: Unlicense
+
+   https://five-embeddev.com/
+
+*/
+
+#ifndef EXAMPLE_SMP_H_
+#define EXAMPLE_SMP_H_
+
+#include "embeddev_riscv.hpp"
+
+void example_smp(riscv_cpu_t& core);
+
+#endif// EXAMPLE_SMP_H_
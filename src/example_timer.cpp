@@ -38,8 +38,9 @@ void example_timer(riscv_cpu_t& core) {
     // Timer driver
     driver::timer<> mtimer;
 
-    // Class to manage timer co-routines
-    scheduler_delay<mtimer_clock> mtimer_coro_scheduler;
+    // Class to manage timer co-routines, sleep in WFI until the next co-routine wakeup.
+    mtimer_idle idle{ core };
+    executor<mtimer_idle<riscv_cpu_t>, mtimer_clock> main_loop{ idle };
     // Global interrupt disable
     riscv::csrs.mstatus.mie.clr();
 
@@ -51,37 +52,27 @@ void example_timer(riscv_cpu_t& core) {
     // Test coro
 
     // Run two concurrent loops. The first loop wil run concurrently to the second loop.
-    auto t0 = resuming_on_delay(mtimer_coro_scheduler, 10s, resume_count_100);
+    auto t0 = resuming_on_delay(main_loop.delay(), 10s, resume_count_100);
     (void)t0;
     // The second loop will finish later than the first loop.
-    auto t1 = resuming_on_delay(mtimer_coro_scheduler, 20s, resume_count_200);
+    auto t1 = resuming_on_delay(main_loop.delay(), 20s, resume_count_200);
     (void)t1;
     // As we are not in a task, at this point the loops have not completed,
     // but have placed work in the schedule.
 
     // The periodic interrupt lambda function.
     // The context (drivers etc) is captured via reference using [&]
-    static const auto handler = [&](void) {
-        auto this_cause = riscv::csrs.mcause.read();
-        if (this_cause & riscv::csr::mcause_data::interrupt::BIT_MASK) {
-            this_cause &= 0xFF;
-            // Known exceptions
-            switch (this_cause) {
-            case riscv::interrupts::mti:
-                timestamp_timer = mtimer.get_time<driver::timer<>::timer_ticks>().count();
-                // Timer interrupt disable
-                riscv::csrs.mie.mti.clr();
-                break;
-            }
-        }
-
-        ;
-
-        // schedule_by_delay<mtimer_clock> now;
-        // auto [pending, next_wake] = mtimer_coro_scheduler.update(now);
+    // This is installed as the timer interrupt vector, so there is no need to decode mcause.
+    static const auto mti_handler = [&](void) {
+        LATENCY_ISR_ENTRY(riscv::interrupts::mti);
+        timestamp_timer = mtimer.get_time<driver::timer<>::timer_ticks>().count();
+        // Timer interrupt disable
+        riscv::csrs.mie.mti.clr();
+        // Periodic PC sampling, if enabled.
+        PC_SAMPLE_TIMER(mtimer);
     };
-    // Install the above lambda function as the machine mode IRQ handler.
-    riscv::irq::handler irq_handler(handler);
+    // Install the above lambda function as the machine mode timer IRQ vector.
+    riscv::irq::vectored_handler irq_handler(riscv::irq::make_vector<riscv::interrupts::mti>(mti_handler));
 
 
     // Timer interrupt enable
@@ -91,26 +82,5 @@ void example_timer(riscv_cpu_t& core) {
 
 
     // Busy loop
-    do {
-        // Get a delay to the next co-routine wakup
-        schedule_by_delay<mtimer_clock> now;
-        TRACE_TIMESTAMP(mtimer.get_time<driver::timer<>::timer_ticks>().count());
-        auto [pending, next_wake] = mtimer_coro_scheduler.resume(now);
-        TRACE_VALUE(coro_pending, pending);
-        TRACE_VALUE(next_wake_delay, next_wake->delay().count());
-        // Wakeup any co-routines waiting for main thread processing.
-        if (pending) {
-            // Next wakeup
-            mtimer.set_time_cmp(next_wake->delay());
-            // Timer interrupt enable
-            riscv::csrs.mstatus.mie.clr();
-            riscv::csrs.mie.mti.set();
-            // WFI Should be called while interrupts are disabled
-            // to ensure interrupt enable and WFI is atomic.
-            core.wfi();
-            riscv::csrs.mstatus.mie.set();
-        }
-    } while (true);
-
-    return;
+    main_loop.run();
 }
@@ -7,6 +7,7 @@
 */
 
 #include <cstdint>
+#include <cstring>
 #include <chrono>
 
 #include "embeddev_riscv.hpp"
@@ -15,15 +16,36 @@
 #include "example_simple.hpp"
 #include "example_irq.hpp"
 #include "example_timer.hpp"
+#include "example_levels.hpp"
+#include "example_smp.hpp"
 
+#if defined(ENABLE_PC_SAMPLING) && !defined(HOST_EMULATION)
+// The PC is sampled from the example_timer interrupt.
+static volatile bool TEST_SIMPLE = false;
+static volatile bool TEST_IRQ = false;
+static volatile bool TEST_TIMERS = true;
+#else
 static volatile bool TEST_SIMPLE = true;
 static volatile bool TEST_IRQ = false;
 static volatile bool TEST_TIMERS = false;
+#endif
+static volatile bool TEST_LEVELS = false;
+static volatile bool TEST_SMP = false;
 
 int main(int argc, const char** argv) {
 #if defined(HOST_EMULATION)
     driver::timer<> mtimer;
     riscv_cpu_t core{ argc, argv, riscv::csrs, mtimer };
+    // Select the example from the command line, e.g. "--example irq"
+    for (int i = 1; i + 1 < argc; i++) {
+        if (std::strcmp(argv[i], "--example") == 0) {
+            TEST_SIMPLE = std::strcmp(argv[i + 1], "simple") == 0;
+            TEST_IRQ = std::strcmp(argv[i + 1], "irq") == 0;
+            TEST_TIMERS = std::strcmp(argv[i + 1], "timer") == 0;
+            TEST_LEVELS = std::strcmp(argv[i + 1], "levels") == 0;
+            TEST_SMP = std::strcmp(argv[i + 1], "smp") == 0;
+        }
+    }
 #else
     (void)argc;
     (void)argv;
@@ -39,5 +61,11 @@ int main(int argc, const char** argv) {
     if (TEST_TIMERS) {
         example_timer(core);
     }
+    if (TEST_LEVELS) {
+        example_levels(core);
+    }
+    if (TEST_SMP) {
+        example_smp(core);
+    }
     return 0;
 }
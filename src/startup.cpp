@@ -9,6 +9,7 @@
 #if !defined(HOST_EMULATION)
 
 #include <algorithm>
+#include <cstddef>
 #include <cstdint>
 
 // Generic C function pointer.
@@ -28,11 +29,23 @@ extern "C" std::uintptr_t metal_segment_itim_target_end;
 extern "C" function_t __init_array_start[];
 extern "C" function_t __init_array_end[];
 
+// Entry point of the secondary harts, called with the mhartid.
+typedef void (*hart_entry_t)(std::size_t);
+
+// Written by the boot hart to release the secondary harts, see riscv/smp.hpp.
+// A magic value is used as the secondary harts may read it before .bss is cleared.
+static constexpr std::uint32_t SECONDARY_RELEASE = 0x5ec0da21;
+extern "C" {
+std::uint32_t _secondary_release;
+hart_entry_t _secondary_entry;
+}
+
 // This function will be placed by the linker script according to the section
 extern "C" void _enter(void) __attribute__((naked, section(".text.metal.init.enter")));
 
 // Define the symbols with "C" naming as they are used by the assembler
 extern "C" void _start(void) __attribute__((noreturn));
+extern "C" void _start_secondary(void) __attribute__((noreturn));
 extern "C" void _Exit(int exit_code) __attribute__((noreturn));
 
 // Standard entry point, no arguments.
@@ -40,12 +53,17 @@ extern int main(int argc, const char** argv);
 
 // The linker script will place this in the reset entry point.
 // It will be 'called' with no stack or C runtime configuration.
-// NOTE - this only supports a single hart.
-// tp will not be initialized
+// Each hart gets a stack of __stack_size below _sp, and tp is set to the mhartid.
+// Hart 0 initializes the C runtime, the other harts wait to be released.
+// Harts with an mhartid >= __num_harts are parked.
 void _enter(void) {
-    // Setup SP and GP
+    // Setup SP, GP and TP
     // The locations are defined in the linker script
     __asm__ volatile(
+        "csrr  a0, mhartid;"
+        "lui   t0, %%hi(__num_harts);"
+        "addi  t0, t0, %%lo(__num_harts);"
+        "bgeu  a0, t0, 2f;"
         ".option push;"
         // The 'norelax' option is critical here.
         // Without 'norelax' the global pointer will
@@ -54,16 +72,40 @@ void _enter(void) {
         "la    gp, __global_pointer$;"
         ".option pop;"
         "la    sp, _sp;"
+        "lui   t0, %%hi(__stack_size);"
+        "addi  t0, t0, %%lo(__stack_size);"
+        "mul   t0, t0, a0;"
+        "sub   sp, sp, t0;"
+        "mv    tp, a0;"
+        "bnez  a0, 1f;"
         "jal   zero, _start;"
+        "1:"
+        "jal   zero, _start_secondary;"
+        "2:"
+        "wfi;"
+        "j     2b;"
         : /* output: none %0 */
         : /* input: none */
         : /* clobbers: none */);
     // This point will not be executed, _start() will be called with no return.
 }
 
+// Hard float targets (e.g. rv32gc) need the FPU on before any FP register is used,
+// interrupt handlers save the FP registers. Set mstatus.FS to initial.
+static inline void enable_fpu(void) {
+#if defined(__riscv_flen)
+    __asm__ volatile("csrs mstatus, %0"
+                     : /* output: none */
+                     : "r"(0x2000) /* input : mstatus.FS = initial */
+                     : /* clobbers: none */);
+#endif
+}
+
 // At this point we have a stack and global poiner, but no access to global variables.
 void _start(void) {
 
+    enable_fpu();
+
     // Init memory regions
     // Clear the .bss section (global variables with no initial values)
     std::fill(&metal_segment_bss_target_start,// cppcheck-suppress mismatchingContainers
@@ -91,6 +133,24 @@ void _start(void) {
     _Exit(rc);
 }
 
+// Secondary harts have a stack, wait for the boot hart to initialize the C runtime.
+void _start_secondary(void) {
+    enable_fpu();
+    while (__atomic_load_n(&_secondary_release, __ATOMIC_ACQUIRE) != SECONDARY_RELEASE) {
+    }
+    std::size_t hart_id;
+    __asm__ volatile("mv %0, tp"
+                     : "=r"(hart_id));
+    _secondary_entry(hart_id);
+    _Exit(0);
+}
+
+// Called by the boot hart after main() has started, see riscv/smp.hpp.
+extern "C" void _release_secondary(hart_entry_t entry) {
+    _secondary_entry = entry;
+    __atomic_store_n(&_secondary_release, SECONDARY_RELEASE, __ATOMIC_RELEASE);
+}
+
 // This should never be called. Busy loop with the CPU in idle state.
 void _Exit(int exit_code) {
     (void)exit_code;
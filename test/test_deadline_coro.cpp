@@ -0,0 +1,172 @@
+/*
+   Unit tests earliest deadline first scheduled co-routines.
+
+   SPDX-License-Identifier: Unlicense
+
+   https://five-embeddev.com/
+
+*/
+
+#include <cstdint>
+#include <coroutine>
+#include <chrono>
+
+#include "unity.h"
+
+#include "coro/scheduler_deadline.hpp"
+#include "coro/nop_task.hpp"
+#include "coro/awaitable_deadline.hpp"
+#include "coro/awaitable_timer.hpp"
+
+#ifdef HOST_EMULATION
+#include "host/timer.hpp"
+using test_clock = host_clock;
+#else
+#include "riscv/scheduler-timer-mtimer.hpp"
+using test_clock = mtimer_clock;
+#endif
+
+// Defined in test_timer_coro.cpp
+extern void sleep_for(test_clock::duration delay);
+
+template<typename SCHEDULER>
+nop_task record_deadline(
+    SCHEDULER& scheduler,
+    std::chrono::microseconds release,
+    std::chrono::microseconds deadline,
+    unsigned int id,
+    unsigned int* order,
+    unsigned int& count,
+    deadline_stats& stats) {
+    co_await scheduled_deadline{ scheduler, release, deadline, &stats };
+    order[count++] = id;
+}
+
+template<typename SCHEDULER>
+nop_task periodic_deadline(
+    SCHEDULER& scheduler,
+    std::chrono::microseconds period,
+    const unsigned int run_count,
+    volatile unsigned int& resume_count,
+    deadline_stats& stats) {
+    for (unsigned int i = 0; i < run_count; i++) {
+        co_await scheduled_deadline{ scheduler, period, period, &stats };
+        resume_count = i + 1;
+    }
+}
+
+void test_deadline_order(void) {
+    scheduler_deadline<test_clock> coro_scheduler;
+    unsigned int order[4]{};
+    unsigned int count{ 0 };
+    deadline_stats stats[4]{};
+
+    // Released together, run by deadline. The late release runs last despite the earliest deadline.
+    auto task1 = record_deadline(coro_scheduler, 10ms, 30ms, 1, order, count, stats[0]);
+    auto task2 = record_deadline(coro_scheduler, 10ms, 10ms, 2, order, count, stats[1]);
+    auto task3 = record_deadline(coro_scheduler, 10ms, 20ms, 3, order, count, stats[2]);
+    auto task4 = record_deadline(coro_scheduler, 15ms, 1ms, 4, order, count, stats[3]);
+
+    sleep_for(12ms);
+    while (count < 3) {
+        auto [pending, next_wake] = coro_scheduler.resume(schedule_by_deadline<test_clock>{});
+        (void)next_wake;
+        TEST_ASSERT_TRUE(pending);
+    }
+    TEST_ASSERT_EQUAL_UINT(2, order[0]);
+    TEST_ASSERT_EQUAL_UINT(3, order[1]);
+    TEST_ASSERT_EQUAL_UINT(1, order[2]);
+
+    // Only task4 is left, it is not released yet.
+    auto [pending, next_wake] = coro_scheduler.resume(schedule_by_deadline<test_clock>{});
+    TEST_ASSERT_TRUE(pending);
+    TEST_ASSERT_TRUE(next_wake.has_value());
+    TEST_ASSERT_TRUE(next_wake->delay() <= 3ms);
+
+    // Run task4 after its deadline.
+    sleep_for(10ms);
+    do {
+        (void)coro_scheduler.resume(schedule_by_deadline<test_clock>{});
+    } while (!(task1.done() && task2.done() && task3.done() && task4.done()));
+
+    TEST_ASSERT_EQUAL_UINT(4, order[3]);
+    TEST_ASSERT_TRUE(coro_scheduler.empty());
+    for (unsigned int i = 0; i < 3; i++) {
+        TEST_ASSERT_EQUAL_UINT(1, stats[i].released);
+        TEST_ASSERT_EQUAL_UINT(0, stats[i].missed);
+    }
+    TEST_ASSERT_EQUAL_UINT(1, stats[3].released);
+    TEST_ASSERT_EQUAL_UINT(1, stats[3].missed);
+    TEST_ASSERT_TRUE(stats[3].max_lateness >= 5ms);
+    TEST_ASSERT_EQUAL_UINT(1, coro_scheduler.missed());
+}
+
+void test_deadline_mixed_rate(void) {
+    scheduler_deadline<test_clock> coro_scheduler;
+    unsigned int resume_count1{ 0 };
+    unsigned int resume_count2{ 0 };
+    deadline_stats stats1{};
+    deadline_stats stats2{};
+    constexpr unsigned int iterations1 = 15;
+    constexpr unsigned int iterations2 = 5;
+
+    auto task1 = periodic_deadline(coro_scheduler, 20ms, iterations1, resume_count1, stats1);
+    auto task2 = periodic_deadline(coro_scheduler, 60ms, iterations2, resume_count2, stats2);
+
+    do {
+        auto [pending, next_wake] = coro_scheduler.resume(schedule_by_deadline<test_clock>{});
+        if (next_wake) {
+            sleep_for(next_wake->delay());
+        }
+    } while (!(task1.done() && task2.done()));
+
+    TEST_ASSERT_EQUAL_UINT(iterations1, resume_count1);
+    TEST_ASSERT_EQUAL_UINT(iterations2, resume_count2);
+    TEST_ASSERT_EQUAL_UINT(iterations1, stats1.released);
+    TEST_ASSERT_EQUAL_UINT(iterations2, stats2.released);
+    TEST_ASSERT_EQUAL_UINT(0, coro_scheduler.missed());
+}
+
+template<typename SCHEDULER>
+nop_task periodic_monitored(
+    SCHEDULER& scheduler,
+    std::chrono::microseconds period,
+    const unsigned int run_count,
+    unsigned int& resume_count,
+    deadline_monitor& monitor) {
+    for (unsigned int i = 0; i < run_count; i++) {
+        co_await scheduled_delay{ scheduler, period, &monitor };
+        resume_count = i + 1;
+    }
+}
+
+void test_deadline_monitor(void) {
+    scheduler_delay<test_clock> coro_scheduler;
+    unsigned int resume_count{ 0 };
+    std::chrono::microseconds overrun_lateness{ 0 };
+    deadline_monitor monitor{ 1ms, 2ms,
+                              [](deadline_monitor& late, std::chrono::microseconds lateness) {
+                                  *static_cast<std::chrono::microseconds*>(late.context) = lateness;
+                              },
+                              &overrun_lateness };
+
+    auto task = periodic_monitored(coro_scheduler, 10ms, 3, resume_count, monitor);
+    // Woken after each delay (10ms) plus the given lateness.
+    const std::chrono::microseconds late[] = { 500us, 2ms, 10ms };
+    for (unsigned int i = 0; i < 3; i++) {
+        sleep_for(10ms + late[i]);
+        while (resume_count == i) {
+            (void)coro_scheduler.resume(schedule_by_delay<test_clock>{});
+        }
+        TEST_ASSERT_EQUAL_UINT(i + 1, monitor.stats.released);
+        if (i < 2) {
+            // Within the deadline, then within the tolerance.
+            TEST_ASSERT_EQUAL_UINT(0, monitor.stats.missed);
+            TEST_ASSERT_TRUE(overrun_lateness == 0us);
+        }
+    }
+    TEST_ASSERT_TRUE(task.done());
+    TEST_ASSERT_EQUAL_UINT(1, monitor.stats.missed);
+    TEST_ASSERT_TRUE(overrun_lateness >= 9ms);
+    TEST_ASSERT_TRUE(monitor.stats.max_lateness == overrun_lateness);
+}
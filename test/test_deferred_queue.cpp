@@ -0,0 +1,119 @@
+/*
+   Unit tests for the deferred work queue.
+
+   SPDX-License-Identifier: Unlicense
+
+   https://five-embeddev.com/
+
+*/
+
+#include <cstdint>
+#include <coroutine>
+
+#include "unity.h"
+
+#include "coro/scheduler.hpp"
+#include "coro/nop_task.hpp"
+#include "coro/awaitable_unordered.hpp"
+#include "coro/deferred_queue.hpp"
+
+template<class SCHEDULER>
+nop_task deferred_coro_loop(SCHEDULER& isr,
+                            SCHEDULER& main,
+                            const unsigned int run_count,
+                            volatile unsigned int& resume_count) {
+
+    for (unsigned int i = 0; i < run_count; i++) {
+        co_await isr;
+        resume_count = i + 1;
+        co_await main;
+    }
+}
+
+void test_deferred_queue_order(void) {
+    deferred_queue<4> queue;
+    unsigned int sequence[4]{};
+    unsigned int count{ 0 };
+    struct record {
+        unsigned int* sequence;
+        unsigned int& count;
+        unsigned int id;
+        void operator()() {
+            sequence[count++] = id;
+        }
+    };
+    record a{ sequence, count, 1 };
+    record b{ sequence, count, 2 };
+    auto call = [](void* context) { (*static_cast<record*>(context))(); };
+
+    TEST_ASSERT_TRUE(queue.empty());
+    TEST_ASSERT_FALSE(queue.drain());
+
+    // Run in posted order
+    TEST_ASSERT_TRUE(queue.post(deferred_work{ call, &b }));
+    TEST_ASSERT_TRUE(queue.post(deferred_work{ call, &a }));
+    TEST_ASSERT_FALSE(queue.empty());
+    TEST_ASSERT_EQUAL_UINT(0, count);
+    TEST_ASSERT_TRUE(queue.drain());
+    TEST_ASSERT_TRUE(queue.empty());
+    TEST_ASSERT_EQUAL_UINT(2, count);
+    TEST_ASSERT_EQUAL_UINT(2, sequence[0]);
+    TEST_ASSERT_EQUAL_UINT(1, sequence[1]);
+
+    // Full queue drops work
+    count = 0;
+    for (unsigned int i = 0; i < 4; i++) {
+        TEST_ASSERT_TRUE(queue.post(deferred_work{ call, &a }));
+    }
+    TEST_ASSERT_FALSE(queue.post(deferred_work{ call, &b }));
+    TEST_ASSERT_EQUAL_UINT(1, queue.dropped());
+    queue.drain();
+    TEST_ASSERT_EQUAL_UINT(4, count);
+}
+
+void test_deferred_queue_resume(void) {
+    deferred_queue<2> queue;
+    scheduler_unordered<1> isr_context;
+    scheduler_unordered<1> main_thread;
+    unsigned int resume_count{ 0 };
+    constexpr unsigned int iterations = 3;
+
+    auto task = deferred_coro_loop(isr_context, main_thread, iterations, resume_count);
+
+    // Resumed directly
+    resume_from_isr<isr_resume::immediate>(isr_context, queue);
+    TEST_ASSERT_EQUAL_UINT(1, resume_count);
+    TEST_ASSERT_TRUE(queue.empty());
+    main_thread.resume();
+
+    // Resume is deferred until the queue is drained
+    resume_from_isr<isr_resume::deferred>(isr_context, queue);
+    TEST_ASSERT_EQUAL_UINT(1, resume_count);
+    queue.drain();
+    TEST_ASSERT_EQUAL_UINT(2, resume_count);
+    main_thread.resume();
+
+    // Post a coroutine handle directly
+    struct awaitable_post {
+        deferred_queue<2>& queue;
+        bool await_ready() noexcept { return false; }
+        void await_suspend(std::coroutine_handle<> handle) noexcept { queue.post(handle); }
+        void await_resume() noexcept {}
+    };
+    auto post_task = [](deferred_queue<2>& q, unsigned int& count) -> nop_task {
+        co_await awaitable_post{ q };
+        count++;
+    };
+    unsigned int post_count{ 0 };
+    auto task2 = post_task(queue, post_count);
+    TEST_ASSERT_EQUAL_UINT(0, post_count);
+    queue.drain();
+    TEST_ASSERT_EQUAL_UINT(1, post_count);
+    TEST_ASSERT_TRUE(task2.done());
+
+    resume_from_isr<isr_resume::deferred>(isr_context, queue);
+    queue.drain();
+    main_thread.resume();
+    TEST_ASSERT_EQUAL_UINT(iterations, resume_count);
+    TEST_ASSERT_TRUE(task.done());
+}
@@ -0,0 +1,163 @@
+/*
+   Unit tests event group co-routines.
+
+   SPDX-License-Identifier: Unlicense
+
+   https://five-embeddev.com/
+
+*/
+
+
+#include <cstdint>
+#include <coroutine>
+
+#include "unity.h"
+
+#include "coro/nop_task.hpp"
+#include "coro/awaitable_event_group.hpp"
+
+template<class EVENT_GROUP>
+nop_task wait_any_loop(EVENT_GROUP& events,
+                       event_mask_t mask,
+                       const unsigned int run_count,
+                       volatile unsigned int& resume_count,
+                       volatile event_mask_t& last_events) {
+    for (unsigned int i = 0; i < run_count; i++) {
+        last_events = co_await events.wait_any(mask);
+        resume_count = i + 1;
+    }
+}
+
+template<class EVENT_GROUP>
+nop_task wait_all_loop(EVENT_GROUP& events,
+                       event_mask_t mask,
+                       const unsigned int run_count,
+                       volatile unsigned int& resume_count,
+                       volatile event_mask_t& last_events) {
+    for (unsigned int i = 0; i < run_count; i++) {
+        last_events = co_await events.wait_all(mask);
+        resume_count = i + 1;
+    }
+}
+
+void test_event_group_wait_any(void) {
+    event_group<2> events;
+    unsigned int resume_count{ 0 };
+    event_mask_t last_events{ 0 };
+    constexpr unsigned int iterations = 4;
+
+    auto task = wait_any_loop(events, 0x3, iterations, resume_count, last_events);
+
+    // No events
+    events.resume();
+    TEST_ASSERT_EQUAL_UINT(0, resume_count);
+
+    // Event not in the mask
+    events.set(0x4);
+    events.resume();
+    TEST_ASSERT_EQUAL_UINT(0, resume_count);
+    TEST_ASSERT_EQUAL_HEX(0x4, events.flags());
+
+    // Event in the mask is consumed
+    events.set(0x2);
+    events.resume();
+    TEST_ASSERT_EQUAL_UINT(1, resume_count);
+    TEST_ASSERT_EQUAL_HEX(0x2, last_events);
+    TEST_ASSERT_EQUAL_HEX(0x4, events.flags());
+
+    // Both events wake once
+    events.set(0x3);
+    events.resume();
+    TEST_ASSERT_EQUAL_UINT(2, resume_count);
+    TEST_ASSERT_EQUAL_HEX(0x3, last_events);
+
+    events.set(0x1);
+    events.resume();
+    events.set(0x1);
+    events.resume();
+    TEST_ASSERT_EQUAL_UINT(iterations, resume_count);
+    TEST_ASSERT_TRUE(task.done());
+    TEST_ASSERT_TRUE(events.empty());
+}
+
+void test_event_group_ready(void) {
+    event_group<1> events;
+    unsigned int resume_count{ 0 };
+    event_mask_t last_events{ 0 };
+
+    // Events set before the wait do not suspend
+    events.set(0x3);
+    auto task = wait_any_loop(events, 0x1, 1, resume_count, last_events);
+    TEST_ASSERT_TRUE(task.done());
+    TEST_ASSERT_TRUE(events.empty());
+    TEST_ASSERT_EQUAL_UINT(1, resume_count);
+    TEST_ASSERT_EQUAL_HEX(0x1, last_events);
+    TEST_ASSERT_EQUAL_HEX(0x2, events.flags());
+}
+
+void test_event_group_wait_all(void) {
+    event_group<2> events;
+    unsigned int resume_count{ 0 };
+    event_mask_t last_events{ 0 };
+    constexpr unsigned int iterations = 2;
+
+    auto task = wait_all_loop(events, 0x5, iterations, resume_count, last_events);
+
+    // Partial set of events does not wake or consume
+    events.set(0x1);
+    events.resume();
+    TEST_ASSERT_EQUAL_UINT(0, resume_count);
+    TEST_ASSERT_EQUAL_HEX(0x1, events.flags());
+
+    events.set(0x4);
+    events.resume();
+    TEST_ASSERT_EQUAL_UINT(1, resume_count);
+    TEST_ASSERT_EQUAL_HEX(0x5, last_events);
+    TEST_ASSERT_EQUAL_HEX(0x0, events.flags());
+
+    // Cleared events do not wake
+    events.set(0x4);
+    events.clear(0x4);
+    events.set(0x1);
+    events.resume();
+    TEST_ASSERT_EQUAL_UINT(1, resume_count);
+
+    events.set(0x4);
+    events.resume();
+    TEST_ASSERT_EQUAL_UINT(iterations, resume_count);
+    TEST_ASSERT_TRUE(task.done());
+}
+
+void test_event_group_multiple_waiters(void) {
+    event_group<2> events;
+    unsigned int resume_count_a{ 0 };
+    unsigned int resume_count_b{ 0 };
+    event_mask_t last_events_a{ 0 };
+    event_mask_t last_events_b{ 0 };
+    constexpr unsigned int iterations = 3;
+
+    auto task_a = wait_any_loop(events, 0x1, iterations, resume_count_a, last_events_a);
+    auto task_b = wait_any_loop(events, 0x3, iterations, resume_count_b, last_events_b);
+
+    // Event is consumed by the first waiter only
+    events.set(0x1);
+    events.resume();
+    TEST_ASSERT_EQUAL_UINT(1, resume_count_a);
+    TEST_ASSERT_EQUAL_UINT(0, resume_count_b);
+
+    // One event for each waiter
+    events.set(0x2);
+    events.resume();
+    TEST_ASSERT_EQUAL_UINT(1, resume_count_a);
+    TEST_ASSERT_EQUAL_UINT(1, resume_count_b);
+    TEST_ASSERT_EQUAL_HEX(0x2, last_events_b);
+
+    do {
+        events.set(0x1);
+        events.resume();
+        events.set(0x2);
+        events.resume();
+    } while (!(task_a.done() && task_b.done()));
+    TEST_ASSERT_EQUAL_UINT(iterations, resume_count_a);
+    TEST_ASSERT_EQUAL_UINT(iterations, resume_count_b);
+}
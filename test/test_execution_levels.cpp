@@ -0,0 +1,193 @@
+/*
+   Unit tests for preemptive execution levels.
+
+   SPDX-License-Identifier: Unlicense
+
+   https://five-embeddev.com/
+
+*/
+
+#include <cstdint>
+#include <coroutine>
+
+#include "unity.h"
+
+#include "coro/nop_task.hpp"
+#include "coro/execution_levels.hpp"
+
+/** Software interrupt emulation.
+    When on_pend is set the interrupt is taken as soon as it is pended,
+    otherwise the test calls dispatch() to take the interrupt.
+ */
+struct test_level_irq {
+    static inline unsigned int pend_count{ 0 };
+    static inline void (*on_pend)(void){ nullptr };
+    static void pend(void) {
+        pend_count++;
+        if (on_pend) {
+            on_pend();
+        }
+    }
+    static void clear(void) {}
+    struct nested {};
+    struct critical {};
+};
+
+using test_levels = execution_levels<test_level_irq, 3, 3>;
+
+/** Record the order co-routines run in and the level they run at. */
+struct level_log {
+    unsigned int id[8];
+    execution_level_t level[8];
+    unsigned int count;
+
+    void add(unsigned int task_id, execution_level_t running_level) {
+        id[count] = task_id;
+        level[count] = running_level;
+        count++;
+    }
+};
+
+nop_task run_at_level(test_levels& levels,
+                      execution_level_t level,
+                      unsigned int task_id,
+                      level_log& log) {
+    co_await levels.run_at(level);
+    log.add(task_id, levels.running_level());
+}
+
+void test_execution_levels_order(void) {
+    test_levels levels;
+    level_log log{};
+    test_level_irq::pend_count = 0;
+    test_level_irq::on_pend = nullptr;
+
+    // Already at the thread level, no switch
+    auto t0 = run_at_level(levels, test_levels::THREAD_LEVEL, 0, log);
+    TEST_ASSERT_TRUE(t0.done());
+    TEST_ASSERT_EQUAL_UINT(1, log.count);
+    TEST_ASSERT_EQUAL_UINT(0, test_level_irq::pend_count);
+
+    // Pended from the thread level
+    auto t1 = run_at_level(levels, 1, 1, log);
+    auto t2 = run_at_level(levels, 2, 2, log);
+    auto t3 = run_at_level(levels, 1, 3, log);
+    TEST_ASSERT_EQUAL_UINT(1, log.count);
+    TEST_ASSERT_EQUAL_UINT(3, test_level_irq::pend_count);
+    TEST_ASSERT_FALSE(levels.empty(1));
+
+    // Highest level first, then in order
+    levels.dispatch();
+    TEST_ASSERT_EQUAL_UINT(4, log.count);
+    TEST_ASSERT_EQUAL_UINT(2, log.id[1]);
+    TEST_ASSERT_EQUAL_UINT(2, log.level[1]);
+    TEST_ASSERT_EQUAL_UINT(1, log.id[2]);
+    TEST_ASSERT_EQUAL_UINT(1, log.level[2]);
+    TEST_ASSERT_EQUAL_UINT(3, log.id[3]);
+    TEST_ASSERT_EQUAL_UINT(1, log.level[3]);
+    TEST_ASSERT_EQUAL_UINT(test_levels::THREAD_LEVEL, levels.running_level());
+    TEST_ASSERT_TRUE(t1.done() && t2.done() && t3.done());
+    TEST_ASSERT_TRUE(levels.empty(1));
+    TEST_ASSERT_TRUE(levels.empty(2));
+}
+
+nop_task wait_level_loop(test_levels& levels,
+                         execution_level_t level,
+                         const unsigned int run_count,
+                         volatile unsigned int& resume_count) {
+    for (unsigned int i = 0; i < run_count; i++) {
+        co_await levels.wait(level);
+        resume_count = i + 1;
+    }
+}
+
+static test_levels* preempt_levels{ nullptr };
+
+nop_task preempted_task(test_levels& levels, level_log& log, nop_task& high, nop_task& low,
+                        unsigned int& low_count, unsigned int& low_count_seen) {
+    co_await levels.run_at(1);
+    log.add(10, levels.running_level());
+    // Preempts this co-routine
+    high = run_at_level(levels, 2, 11, log);
+    // Equal level, does not preempt
+    low = wait_level_loop(levels, 1, 1, low_count);
+    levels.pend(1);
+    log.add(12, levels.running_level());
+    low_count_seen = low_count;
+}
+
+void test_execution_levels_preempt(void) {
+    test_levels levels;
+    level_log log{};
+    nop_task high;
+    nop_task low;
+    unsigned int low_count{ 0 };
+    unsigned int low_count_seen{ 0 };
+    preempt_levels = &levels;
+    test_level_irq::pend_count = 0;
+    // Take the interrupt as soon as it is pended
+    test_level_irq::on_pend = []() { preempt_levels->dispatch(); };
+
+    auto task = preempted_task(levels, log, high, low, low_count, low_count_seen);
+    test_level_irq::on_pend = nullptr;
+
+    TEST_ASSERT_TRUE(task.done());
+    TEST_ASSERT_TRUE(high.done());
+    TEST_ASSERT_TRUE(low.done());
+    TEST_ASSERT_EQUAL_UINT(1, low_count);
+    TEST_ASSERT_EQUAL_UINT(3, log.count);
+    TEST_ASSERT_EQUAL_UINT(10, log.id[0]);
+    TEST_ASSERT_EQUAL_UINT(11, log.id[1]);
+    TEST_ASSERT_EQUAL_UINT(2, log.level[1]);
+    // The equal level ran after this co-routine completed
+    TEST_ASSERT_EQUAL_UINT(12, log.id[2]);
+    TEST_ASSERT_EQUAL_UINT(1, log.level[2]);
+    TEST_ASSERT_EQUAL_UINT(0, low_count_seen);
+    TEST_ASSERT_EQUAL_UINT(test_levels::THREAD_LEVEL, levels.running_level());
+}
+
+void test_execution_levels_lock(void) {
+    test_levels levels;
+    unsigned int resume_count_1{ 0 };
+    unsigned int resume_count_2{ 0 };
+    constexpr unsigned int iterations = 2;
+    test_level_irq::pend_count = 0;
+    test_level_irq::on_pend = nullptr;
+
+    auto t1 = wait_level_loop(levels, 1, iterations, resume_count_1);
+    auto t2 = wait_level_loop(levels, 2, iterations, resume_count_2);
+
+    // Waiting co-routines don't pend
+    TEST_ASSERT_EQUAL_UINT(0, test_level_irq::pend_count);
+    levels.dispatch();
+    TEST_ASSERT_EQUAL_UINT(0, resume_count_1);
+
+    {
+        auto lock = levels.lock(1);
+        TEST_ASSERT_EQUAL_UINT(1, levels.running_level());
+        // Level under the ceiling does not raise the interrupt.
+        levels.pend(1);
+        TEST_ASSERT_EQUAL_UINT(0, test_level_irq::pend_count);
+        // Level above the ceiling preempts.
+        levels.pend(2);
+        TEST_ASSERT_EQUAL_UINT(1, test_level_irq::pend_count);
+        levels.dispatch();
+        TEST_ASSERT_EQUAL_UINT(1, resume_count_2);
+        TEST_ASSERT_EQUAL_UINT(0, resume_count_1);
+        TEST_ASSERT_EQUAL_UINT(1, levels.running_level());
+    }
+    // Released, the level pended while locked raises the interrupt.
+    TEST_ASSERT_EQUAL_UINT(2, test_level_irq::pend_count);
+    TEST_ASSERT_EQUAL_UINT(test_levels::THREAD_LEVEL, levels.running_level());
+    levels.dispatch();
+    TEST_ASSERT_EQUAL_UINT(1, resume_count_1);
+
+    // Re-waiting co-routines run once per pend
+    levels.pend(1);
+    levels.pend(2);
+    levels.dispatch();
+    TEST_ASSERT_EQUAL_UINT(iterations, resume_count_1);
+    TEST_ASSERT_EQUAL_UINT(iterations, resume_count_2);
+    TEST_ASSERT_TRUE(t1.done());
+    TEST_ASSERT_TRUE(t2.done());
+}
@@ -0,0 +1,130 @@
+/*
+   Unit tests for the executor composing the main loop schedulers.
+
+   SPDX-License-Identifier: Unlicense
+
+   https://five-embeddev.com/
+
+*/
+
+#include <cstdint>
+#include <coroutine>
+#include <chrono>
+#include <optional>
+
+#include "unity.h"
+
+#include "coro/executor.hpp"
+#include "coro/nop_task.hpp"
+#include "coro/awaitable_timer.hpp"
+#include "coro/awaitable_priority.hpp"
+#include "coro/awaitable_unordered.hpp"
+
+#ifdef HOST_EMULATION
+#include "host/timer.hpp"
+using test_clock = host_clock;
+#else
+#include "riscv/scheduler-timer-mtimer.hpp"
+using test_clock = mtimer_clock;
+#endif
+
+// Defined in test_timer_coro.cpp
+extern void sleep_for(test_clock::duration delay);
+
+/** Idle by sleeping until the next delay, count the waits.
+ */
+struct test_idle {
+    unsigned int waits{ 0 };
+    unsigned int sleeps{ 0 };
+
+    template<class DURATION, class IDLE_TEST>
+    void wait(const std::optional<DURATION>& delay, IDLE_TEST idle_test) {
+        waits++;
+        if (delay && idle_test()) {
+            sleeps++;
+            sleep_for(*delay);
+        }
+    }
+};
+
+/** Record the order work was run.
+ */
+struct run_order {
+    unsigned int order[8]{};
+    unsigned int count{ 0 };
+
+    void record(unsigned int id) {
+        order[count++] = id;
+    }
+};
+
+template<typename SCHEDULER>
+nop_task record_main(SCHEDULER& scheduler, unsigned int id, run_order& run) {
+    co_await scheduler;
+    run.record(id);
+}
+
+template<typename SCHEDULER>
+nop_task record_priority(SCHEDULER& scheduler, int priority, unsigned int id, run_order& run) {
+    co_await scheduled_priority{ scheduler, priority };
+    run.record(id);
+}
+
+template<typename SCHEDULER>
+nop_task record_delay(SCHEDULER& scheduler, std::chrono::microseconds delay, unsigned int id, run_order& run) {
+    co_await scheduled_delay{ scheduler, delay };
+    run.record(id);
+}
+
+void test_executor_order(void) {
+    test_idle idle;
+    executor<test_idle, test_clock> main_loop{ idle };
+    run_order run;
+
+    auto t0 = record_delay(main_loop.delay(), 20ms, 6, run);
+    auto t1 = record_delay(main_loop.delay(), 10ms, 5, run);
+    auto t2 = record_priority(main_loop.priority(), 1, 4, run);
+    auto t3 = record_priority(main_loop.priority(), 2, 3, run);
+    auto t4 = record_main(main_loop.main(), 2, run);
+    main_loop.deferred().post(deferred_work{ [](void* context) {
+                                                 static_cast<run_order*>(context)->record(1);
+                                             },
+                                             &run });
+
+    // The ready work is run, then the loop sleeps until the first delay.
+    TEST_ASSERT_TRUE(main_loop.run_once());
+    TEST_ASSERT_EQUAL_UINT(4, run.count);
+    TEST_ASSERT_EQUAL_UINT(1, idle.waits);
+    TEST_ASSERT_EQUAL_UINT(1, idle.sleeps);
+
+    while (main_loop.run_once()) {
+    }
+    TEST_ASSERT_TRUE(t0.done() && t1.done() && t2.done() && t3.done() && t4.done());
+    TEST_ASSERT_EQUAL_UINT(6, run.count);
+    for (unsigned int i = 0; i < run.count; i++) {
+        TEST_ASSERT_EQUAL_UINT(i + 1, run.order[i]);
+    }
+    // Nothing is pending, the last wait has no delay.
+    TEST_ASSERT_EQUAL_UINT(idle.waits, idle.sleeps + 1);
+}
+
+void test_executor_isr(void) {
+    test_idle idle;
+    executor<test_idle, test_clock> main_loop{ idle };
+    run_order run;
+
+    auto t0 = record_main(main_loop.isr(), 1, run);
+    TEST_ASSERT_FALSE(main_loop.run_once());
+    TEST_ASSERT_EQUAL_UINT(0, run.count);
+
+    // As the interrupt handler would.
+    main_loop.resume_isr();
+    TEST_ASSERT_TRUE(t0.done());
+    TEST_ASSERT_EQUAL_UINT(1, run.order[0]);
+
+    // Each pass runs the main loop co-routines.
+    auto t1 = record_main(main_loop.main(), 2, run);
+    TEST_ASSERT_TRUE(main_loop.run_ready());
+    TEST_ASSERT_TRUE(t1.done());
+    TEST_ASSERT_FALSE(main_loop.run_ready());
+}
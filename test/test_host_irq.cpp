@@ -0,0 +1,172 @@
+/*
+   Unit tests for the host emulation of interrupts.
+
+   SPDX-License-Identifier: Unlicense
+
+   https://five-embeddev.com/
+
+*/
+
+#include <cstdint>
+#include <chrono>
+
+#include "unity.h"
+
+#ifdef HOST_EMULATION
+#include <thread>
+
+#include "host/riscv-csr.hpp"
+#include "host/riscv-cpu.hpp"
+#include "host/riscv-irq.hpp"
+#include "host/timer.hpp"
+#include "coro/nop_task.hpp"
+#include "coro/awaitable_unordered.hpp"
+
+using namespace std::literals::chrono_literals;
+
+using test_cpu = riscv::cpu<riscv::csr_s, driver::timer<>>;
+
+void test_host_irq_masking(void) {
+    unsigned int count{ 0 };
+    riscv::uint_xlen_t last_cause{ 0 };
+    const auto handler = [&](void) {
+        count++;
+        last_cause = riscv::csrs.mcause.read();
+        // Interrupts are disabled in the handler
+        TEST_ASSERT_FALSE(riscv::csrs.mstatus.mie.read());
+    };
+    riscv::irq::handler irq_handler(handler);
+
+    // Masked by mstatus.mie
+    riscv::csrs.mie.mei.set();
+    host::irq_lines.raise(riscv::interrupts::mei);
+    TEST_ASSERT_EQUAL_UINT(0, count);
+
+    // Taken when enabled, and only once.
+    riscv::csrs.mstatus.mie.set();
+    TEST_ASSERT_EQUAL_UINT(1, count);
+    TEST_ASSERT_EQUAL_HEX(riscv::csr::mcause_data::interrupt::BIT_MASK | riscv::interrupts::mei, last_cause);
+    TEST_ASSERT_TRUE(riscv::csrs.mstatus.mie.read());
+
+    // Raised on the hart thread while enabled, taken immediately.
+    host::irq_lines.raise(riscv::interrupts::mei);
+    TEST_ASSERT_EQUAL_UINT(2, count);
+
+    // Masked by mie
+    riscv::csrs.mie.mei.clr();
+    host::irq_lines.raise(riscv::interrupts::mei);
+    TEST_ASSERT_EQUAL_UINT(2, count);
+    riscv::csrs.mie.mei.set();
+    TEST_ASSERT_EQUAL_UINT(3, count);
+
+    riscv::csrs.mstatus.mie.clr();
+    riscv::csrs.mie.mei.clr();
+    host::irq_lines.reset();
+}
+
+template<class SCHEDULER>
+nop_task isr_resume_loop(SCHEDULER& isr_context,
+                         SCHEDULER& main_thread,
+                         const unsigned int run_count,
+                         volatile unsigned int& resume_count) {
+    for (unsigned int i = 0; i < run_count; i++) {
+        co_await isr_context;
+        resume_count = i + 1;
+        co_await main_thread;
+    }
+}
+
+void test_host_irq_sources(void) {
+    driver::timer<> mtimer;
+    test_cpu core{ 0, nullptr, riscv::csrs, mtimer };
+    scheduler_unordered<1> isr_mei_context;
+    scheduler_unordered<1> main_thread;
+    unsigned int resume_count{ 0 };
+    unsigned int mti_count{ 0 };
+    constexpr unsigned int iterations = 10;
+
+    auto task = isr_resume_loop(isr_mei_context, main_thread, iterations, resume_count);
+
+    static const auto mei_handler = [&](void) {
+        isr_mei_context.resume();
+    };
+    static const auto mti_handler = [&](void) {
+        mti_count++;
+        riscv::csrs.mie.mti.clr();
+    };
+    riscv::irq::vectored_handler irq_handler(riscv::irq::make_vector<riscv::interrupts::mei>(mei_handler),
+                                             riscv::irq::make_vector<riscv::interrupts::mti>(mti_handler));
+
+    // External interrupt every 100us, timer after 250us
+    TEST_ASSERT_TRUE(host::irq_lines.add_source(riscv::interrupts::mei, 100us));
+    mtimer.set_time_cmp(250us);
+    riscv::csrs.mie.mei.set();
+    riscv::csrs.mie.mti.set();
+    const auto start_time = host_clock::now();
+    do {
+        riscv::csrs.mstatus.mie.clr();
+        core.wfi();
+        riscv::csrs.mstatus.mie.set();
+        main_thread.resume();
+    } while (!task.done());
+    const auto elapsed_time = host_clock::now() - start_time;
+
+    TEST_ASSERT_EQUAL_UINT(iterations, resume_count);
+    TEST_ASSERT_EQUAL_UINT(iterations, host::irq_lines.source_count(riscv::interrupts::mei));
+    TEST_ASSERT_EQUAL_UINT(1, mti_count);
+    TEST_ASSERT_TRUE(elapsed_time >= 1ms);
+#if defined(HOST_VIRTUAL_TIME)
+    // Deterministic, the source is the only event after the timer.
+    TEST_ASSERT_EQUAL_UINT(iterations + 1, core.stats().wakeups);
+    TEST_ASSERT_TRUE(elapsed_time < 1ms + 1us);
+#endif
+
+    riscv::csrs.mstatus.mie.clr();
+    riscv::csrs.mie.mei.clr();
+    host::irq_lines.reset();
+}
+
+void test_host_irq_thread(void) {
+    driver::timer<> mtimer;
+    test_cpu core{ 0, nullptr, riscv::csrs, mtimer };
+    unsigned int count{ 0 };
+    constexpr unsigned int iterations = 5;
+    static const auto msi_handler = [&](void) {
+        count++;
+        host::irq_lines.set_level(riscv::interrupts::msi, false);
+    };
+    riscv::irq::vectored_handler irq_handler(riscv::irq::make_vector<riscv::interrupts::msi>(msi_handler));
+    riscv::csrs.mie.msi.set();
+
+    // Interrupts raised from another thread wakeup wfi(), the handler runs on this thread.
+    for (unsigned int i = 0; i < iterations; i++) {
+        std::thread injector([]() { host::irq_lines.set_level(riscv::interrupts::msi, true); });
+        riscv::csrs.mstatus.mie.clr();
+        core.wfi();
+        riscv::csrs.mstatus.mie.set();
+        injector.join();
+        // Taken here if it was raised after wfi() returned.
+        riscv::csrs.mstatus.mie.set();
+        TEST_ASSERT_EQUAL_UINT(i + 1, count);
+    }
+
+    riscv::csrs.mstatus.mie.clr();
+    riscv::csrs.mie.msi.clr();
+    host::irq_lines.reset();
+}
+
+#else
+
+void test_host_irq_masking(void) {
+    TEST_IGNORE_MESSAGE("Host emulation only");
+}
+
+void test_host_irq_sources(void) {
+    TEST_IGNORE_MESSAGE("Host emulation only");
+}
+
+void test_host_irq_thread(void) {
+    TEST_IGNORE_MESSAGE("Host emulation only");
+}
+
+#endif
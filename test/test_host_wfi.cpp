@@ -0,0 +1,89 @@
+/*
+   Unit tests for the host emulation of wfi().
+
+   SPDX-License-Identifier: Unlicense
+
+   https://five-embeddev.com/
+
+*/
+
+#include <atomic>
+#include <cstdint>
+#include <chrono>
+#include <thread>
+
+#include "unity.h"
+
+#ifdef HOST_EMULATION
+#include "host/riscv-csr.hpp"
+#include "host/riscv-cpu.hpp"
+#include "host/timer.hpp"
+
+using namespace std::literals::chrono_literals;
+
+using test_cpu = riscv::cpu<riscv::csr_s, driver::timer<>>;
+
+void test_host_wfi_timer(void) {
+    driver::timer<> mtimer;
+    test_cpu core{ 0, nullptr, riscv::csrs, mtimer };
+
+    riscv::csrs.mie.mti.set();
+    const auto start_time = host_clock::now();
+    mtimer.set_time_cmp(5ms);
+    TEST_ASSERT_EQUAL_HEX(0, host::irq_lines.pending() & host::emulated_irq::MTI_BIT);
+
+    // Blocks until mtimecmp
+    core.wfi();
+    const auto elapsed_time = host_clock::now() - start_time;
+    TEST_ASSERT_TRUE(elapsed_time >= 5ms);
+#if defined(HOST_VIRTUAL_TIME)
+    // Virtual time is fast forwarded to mtimecmp.
+    TEST_ASSERT_TRUE(elapsed_time < 5ms + 1us);
+#endif
+    TEST_ASSERT_EQUAL_HEX(host::emulated_irq::MTI_BIT, host::irq_lines.pending() & host::emulated_irq::MTI_BIT);
+    TEST_ASSERT_EQUAL_UINT(1, core.stats().wakeups);
+
+    // Already pending, does not block
+    core.wfi();
+    TEST_ASSERT_EQUAL_UINT(2, core.stats().wakeups);
+    riscv::csrs.mie.mti.clr();
+}
+
+void test_host_wfi_inject(void) {
+    driver::timer<> mtimer;
+    test_cpu core{ 0, nullptr, riscv::csrs, mtimer };
+
+    // The timer is not enabled, wakeup on the injected interrupt.
+    mtimer.set_time_cmp(1h);
+    riscv::csrs.mie.mei.set();
+    const auto start_time = host_clock::now();
+    TEST_ASSERT_EQUAL_HEX(0, host::irq_lines.pending());
+
+    // Raised from another thread while wfi() is blocked.
+    std::atomic<bool> raised{ false };
+    std::thread irq_thread([&raised]() {
+        std::this_thread::sleep_for(std::chrono::milliseconds(20));
+        raised = true;
+        host::irq_lines.raise(riscv::interrupts::mei);
+    });
+    core.wfi();
+    TEST_ASSERT_TRUE(raised);
+    irq_thread.join();
+    TEST_ASSERT_TRUE(host_clock::now() - start_time < 1h);
+    TEST_ASSERT_EQUAL_UINT(1, core.stats().wakeups);
+    host::irq_lines.lower(riscv::interrupts::mei);
+    TEST_ASSERT_EQUAL_HEX(0, host::irq_lines.pending());
+    riscv::csrs.mie.mei.clr();
+}
+
+#else
+
+void test_host_wfi_timer(void) {
+    TEST_IGNORE_MESSAGE("Host emulation only");
+}
+
+void test_host_wfi_inject(void) {
+    TEST_IGNORE_MESSAGE("Host emulation only");
+}
+
+#endif
@@ -0,0 +1,68 @@
+/*
+   Unit tests for the wakeup jitter histogram.
+
+   SPDX-License-Identifier: Unlicense
+
+   https://five-embeddev.com/
+
+*/
+
+#include <cstdint>
+#include <chrono>
+
+#include "unity.h"
+
+#include "debug/jitter.hpp"
+
+void test_jitter_buckets(void) {
+    using histogram = log_linear_histogram<3>;
+    // Small values have their own bucket.
+    for (std::uint32_t value = 0; value < 16; value++) {
+        TEST_ASSERT_EQUAL_UINT(value, histogram::bucket(value));
+        TEST_ASSERT_EQUAL_UINT(value, histogram::bucket_max(value));
+    }
+    // Then 8 buckets per power of 2.
+    TEST_ASSERT_EQUAL_UINT(16, histogram::bucket(16));
+    TEST_ASSERT_EQUAL_UINT(16, histogram::bucket(17));
+    TEST_ASSERT_EQUAL_UINT(17, histogram::bucket(18));
+    TEST_ASSERT_EQUAL_UINT(23, histogram::bucket(31));
+    TEST_ASSERT_EQUAL_UINT(24, histogram::bucket(32));
+    TEST_ASSERT_EQUAL_UINT(31, histogram::bucket_max(23));
+    TEST_ASSERT_EQUAL_UINT(histogram::BUCKETS - 1, histogram::bucket(0xFFFFFFFF));
+    TEST_ASSERT_EQUAL_UINT(0xFFFFFFFF, histogram::bucket_max(histogram::BUCKETS - 1));
+    // Each value is at most the upper bound of its bucket, within 1/8.
+    for (std::uint32_t value = 1; value < 0x80000000; value = value * 3 + 1) {
+        const auto upper = histogram::bucket_max(histogram::bucket(value));
+        TEST_ASSERT_TRUE(upper >= value);
+        TEST_ASSERT_TRUE(upper - value <= value / 8);
+    }
+}
+
+void test_jitter_percentile(void) {
+    log_linear_histogram<3> stats{};
+    TEST_ASSERT_EQUAL_UINT(0, stats.percentile(50));
+
+    for (std::uint32_t value = 1; value <= 100; value++) {
+        stats.add(value * 1000);
+    }
+    TEST_ASSERT_EQUAL_UINT(100, stats.count);
+    TEST_ASSERT_EQUAL_UINT(1000, stats.min);
+    TEST_ASSERT_EQUAL_UINT(100000, stats.max);
+    // Within the bucket error above the exact value.
+    TEST_ASSERT_TRUE(stats.percentile(50) >= 50000 && stats.percentile(50) <= 50000 + 50000 / 8);
+    TEST_ASSERT_TRUE(stats.percentile(99) >= 99000 && stats.percentile(99) <= 100000);
+    TEST_ASSERT_EQUAL_UINT(100000, stats.percentile(100));
+    TEST_ASSERT_EQUAL_UINT(100000, stats.percentile(999, 1000));
+}
+
+void test_jitter_log(void) {
+    jitter_log_manager::reset();
+    jitter_log_manager::wakeup(std::chrono::microseconds(5));
+    jitter_log_manager::wakeup(std::chrono::nanoseconds(-1));
+    jitter_log_manager::wakeup(std::chrono::seconds(10));
+    TEST_ASSERT_EQUAL_UINT(3, wakeup_jitter_log.count);
+    TEST_ASSERT_EQUAL_UINT(0, wakeup_jitter_log.min);
+    TEST_ASSERT_EQUAL_UINT(0xFFFFFFFF, wakeup_jitter_log.max);
+    TEST_ASSERT_EQUAL_UINT(1, wakeup_jitter_log.histogram[log_linear_histogram<>::bucket(5000)]);
+    jitter_log_manager::reset();
+}
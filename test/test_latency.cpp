@@ -0,0 +1,70 @@
+/*
+   Unit tests for interrupt to co-routine latency aggregation.
+
+   SPDX-License-Identifier: Unlicense
+
+   https://five-embeddev.com/
+
+*/
+
+#include <cstdint>
+
+#include "unity.h"
+
+#include "debug/latency.hpp"
+
+void test_latency_stats(void) {
+    latency_stats stats{};
+
+    TEST_ASSERT_EQUAL_UINT(0, stats.average());
+
+    stats.add(0);
+    stats.add(3);
+    stats.add(4);
+    stats.add(9);
+    stats.add(0xFFFFFFFF);
+
+    TEST_ASSERT_EQUAL_UINT(5, stats.count);
+    TEST_ASSERT_EQUAL_UINT(0, stats.min);
+    TEST_ASSERT_EQUAL_UINT(0xFFFFFFFF, stats.max);
+    TEST_ASSERT_EQUAL_UINT((0xFFFFFFFFULL + 16) / 5, stats.average());
+    // Log2 buckets
+    TEST_ASSERT_EQUAL_UINT(1, stats.histogram[0]);
+    TEST_ASSERT_EQUAL_UINT(1, stats.histogram[2]);
+    TEST_ASSERT_EQUAL_UINT(1, stats.histogram[3]);
+    TEST_ASSERT_EQUAL_UINT(1, stats.histogram[4]);
+    // Overflow bucket
+    TEST_ASSERT_EQUAL_UINT(1, stats.histogram[LATENCY_HISTOGRAM_BUCKETS - 1]);
+}
+
+void test_latency_log(void) {
+    constexpr unsigned int cause = 7;
+    latency_log_manager::reset();
+
+    // Only the first dispatch and resume after ISR entry are recorded.
+    latency_log_manager::isr_entry(cause);
+    latency_log_manager::dispatch();
+    latency_log_manager::dispatch();
+    latency_log_manager::resume();
+    latency_log_manager::resume();
+    TEST_ASSERT_EQUAL_UINT(1, latency_log[cause].dispatch.count);
+    TEST_ASSERT_EQUAL_UINT(1, latency_log[cause].resume.count);
+    TEST_ASSERT_TRUE(latency_log[cause].dispatch.min <= latency_log[cause].resume.min);
+
+    // Nothing is recorded without an ISR
+    latency_log_manager::dispatch();
+    latency_log_manager::resume();
+    TEST_ASSERT_EQUAL_UINT(1, latency_log[cause].dispatch.count);
+    TEST_ASSERT_EQUAL_UINT(1, latency_log[cause].resume.count);
+
+    // The interrupt bit of mcause is ignored, out of range causes are not recorded.
+    latency_log_manager::isr_entry((1UL << 31) | cause);
+    latency_log_manager::resume();
+    TEST_ASSERT_EQUAL_UINT(2, latency_log[cause].resume.count);
+    latency_log_manager::isr_entry(LATENCY_CAUSE_COUNT);
+    latency_log_manager::resume();
+    TEST_ASSERT_EQUAL_UINT(2, latency_log[cause].resume.count);
+
+    latency_log_manager::reset();
+    TEST_ASSERT_EQUAL_UINT(0, latency_log[cause].resume.count);
+}
@@ -0,0 +1,116 @@
+/*
+   Unit tests for the PC sampling histogram.
+
+   SPDX-License-Identifier: Unlicense
+
+   https://five-embeddev.com/
+
+*/
+
+#include <cstdint>
+#include <chrono>
+#include <optional>
+
+#include "unity.h"
+
+#include "debug/pc_sampler.hpp"
+
+#if defined(HOST_EMULATION)
+#include "host/riscv-csr.hpp"
+#include "host/riscv-cpu.hpp"
+#include "host/timer.hpp"
+#include "platform/executor-idle-mtimer.hpp"
+#endif
+
+void test_pc_sampler(void) {
+    pc_sampler::reset();
+
+    pc_sampler::sample(0x20010000);
+    pc_sampler::sample(0x20010004);
+    pc_sampler::sample(0x20010000);
+    pc_sampler::sample(0x20010002);
+
+    TEST_ASSERT_EQUAL_UINT(4, pc_sample_log.samples);
+    TEST_ASSERT_EQUAL_UINT(0, pc_sample_log.dropped);
+    TEST_ASSERT_EQUAL_UINT(2, pc_sampler::count(0x20010000));
+    TEST_ASSERT_EQUAL_UINT(1, pc_sampler::count(0x20010002));
+    TEST_ASSERT_EQUAL_UINT(1, pc_sampler::count(0x20010004));
+    TEST_ASSERT_EQUAL_UINT(0, pc_sampler::count(0x20010006));
+}
+
+void test_pc_sampler_full(void) {
+    pc_sampler::reset();
+
+    // More distinct PCs than entries, the samples that don't fit are dropped.
+    constexpr std::uint32_t pcs = 2 * PC_SAMPLE_ENTRIES;
+    for (std::uint32_t i = 0; i < pcs; i++) {
+        pc_sampler::sample(0x20010000 + 2 * i);
+    }
+    std::uint32_t recorded{ 0 };
+    for (const auto& entry : pc_sample_log.histogram) {
+        recorded += static_cast<std::uint32_t>(entry.count);
+    }
+    TEST_ASSERT_EQUAL_UINT(pcs, pc_sample_log.samples);
+    TEST_ASSERT_TRUE(pc_sample_log.dropped >= pcs - PC_SAMPLE_ENTRIES);
+    TEST_ASSERT_EQUAL_UINT(pcs, recorded + pc_sample_log.dropped);
+    pc_sampler::reset();
+}
+
+void test_pc_sampler_sleep(void) {
+    using std::chrono::microseconds;
+    // Not sampling, max_sleep is not changed.
+    TEST_ASSERT_EQUAL_INT64(0, pc_sample_sleep(microseconds{ 0 }, microseconds{ 0 }).count());
+    TEST_ASSERT_EQUAL_INT64(500, pc_sample_sleep(microseconds{ 500 }, microseconds{ 0 }).count());
+    // Sampling, the sleep is limited to the sample period.
+    TEST_ASSERT_EQUAL_INT64(100, pc_sample_sleep(microseconds{ 0 }, microseconds{ 100 }).count());
+    TEST_ASSERT_EQUAL_INT64(100, pc_sample_sleep(microseconds{ 500 }, microseconds{ 100 }).count());
+    TEST_ASSERT_EQUAL_INT64(50, pc_sample_sleep(microseconds{ 50 }, microseconds{ 100 }).count());
+#if defined(ENABLE_PC_SAMPLING) && !defined(HOST_EMULATION)
+    TEST_ASSERT_EQUAL_INT64(PC_SAMPLE_PERIOD_US, pc_sample_max_sleep.count());
+#else
+    TEST_ASSERT_EQUAL_INT64(0, pc_sample_max_sleep.count());
+#endif
+}
+
+#if defined(HOST_EMULATION)
+
+using test_cpu = riscv::cpu<riscv::csr_s, driver::timer<>>;
+
+void test_pc_sampler_idle(void) {
+    driver::timer<> mtimer;
+    test_cpu core{ 0, nullptr, riscv::csrs, mtimer };
+    // No max_sleep, it is limited by the sample period, as pc_sample_max_sleep does on the target.
+    constexpr std::chrono::microseconds sample_period{ PC_SAMPLE_PERIOD_US };
+    constexpr std::chrono::microseconds scheduler_period{ 10 * PC_SAMPLE_PERIOD_US };
+    mtimer_idle<test_cpu> idle{ core, std::chrono::microseconds::zero(), sample_period };
+    pc_sampler::reset();
+
+    // Idle until the next scheduled wakeup, each timer interrupt takes a sample.
+    const auto wake = host_clock::now() + scheduler_period;
+    while (host_clock::now() < wake) {
+        idle.wait(std::optional<host_clock::duration>{ wake - host_clock::now() }, []() { return true; });
+        if (host::irq_lines.pending() & host::emulated_irq::MTI_BIT) {
+            riscv::csrs.mie.mti.clr();
+            pc_sampler::sample(0x20010000);
+        }
+    }
+#if defined(HOST_VIRTUAL_TIME)
+    // A sample each period, not only at the scheduled wakeup.
+    TEST_ASSERT_EQUAL_UINT(scheduler_period / sample_period, pc_sample_log.samples);
+#else
+    // Late wakeups in real time stretch the sample period.
+    TEST_ASSERT_TRUE(pc_sample_log.samples >= 1);
+    TEST_ASSERT_TRUE(pc_sample_log.samples <= scheduler_period / sample_period);
+#endif
+    riscv::csrs.mie.mti.clr();
+    riscv::csrs.mstatus.mie.clr();
+    pc_sampler::reset();
+}
+
+#else
+
+void test_pc_sampler_idle(void) {
+    TEST_IGNORE_MESSAGE("Host emulation only");
+}
+
+#endif
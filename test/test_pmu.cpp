@@ -0,0 +1,62 @@
+/*
+   Unit tests for the performance counter driver.
+
+   SPDX-License-Identifier: Unlicense
+
+   https://five-embeddev.com/
+
+*/
+
+#include <cstdint>
+#include <array>
+
+#include "unity.h"
+
+#ifdef HOST_EMULATION
+#include "host/pmu.hpp"
+#else
+#include "riscv/pmu.hpp"
+#endif
+
+static volatile std::uint32_t pmu_sink{ 0 };
+
+static void pmu_work(unsigned int loops) {
+    for (unsigned int i = 0; i < loops; i++) {
+        if (i & 1) {
+            pmu_sink = i;
+        }
+    }
+}
+
+void test_pmu(void) {
+    driver::pmu<3> counters{ { driver::pmu_event::cycles,
+                               driver::pmu_event::instructions,
+                               driver::pmu_event::branches } };
+    TEST_ASSERT_TRUE(counters.events()[2] == driver::pmu_event::branches);
+
+    counters.start();
+    pmu_work(1000);
+    counters.stop();
+    // The events may not be available, e.g. on a host without access to perf events.
+    for (std::size_t i = 0; i < counters.events().size(); i++) {
+        if (!counters.supported(i)) {
+            TEST_ASSERT_EQUAL_UINT64(0, counters.value(i));
+        }
+    }
+    if (counters.supported(1)) {
+        TEST_ASSERT_TRUE(counters.value(1) >= 1000);
+    }
+
+    // Counts accumulate over regions, not outside them.
+    const auto first = counters.value(1);
+    pmu_work(100000);
+    counters.start();
+    pmu_work(1000);
+    counters.stop();
+    if (counters.supported(1)) {
+        TEST_ASSERT_TRUE(counters.value(1) > first);
+        TEST_ASSERT_TRUE(counters.value(1) < first + 100000);
+    }
+    counters.reset();
+    TEST_ASSERT_EQUAL_UINT64(0, counters.value(0));
+}
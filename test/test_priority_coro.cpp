@@ -22,6 +22,7 @@
 #include "coro/scheduler.hpp"
 #include "coro/nop_task.hpp"
 #include "coro/awaitable_priority.hpp"
+#include "coro/scheduler_aging.hpp"
 
 template<typename SCHEDULER>
 nop_task resuming_on_priority(
@@ -48,3 +49,56 @@ void test_single_prio_coroutine(void) {
     } while (!task.done());
     TEST_ASSERT_EQUAL_UINT(resume_count, iterations);
 }
+
+template<typename SCHEDULER>
+nop_task record_priority(
+    SCHEDULER& scheduler,
+    int priority,
+    const unsigned int run_count,
+    unsigned int id,
+    unsigned int* order,
+    unsigned int& count) {
+    for (unsigned int i = 0; i < run_count; i++) {
+        co_await scheduled_priority{ scheduler, priority };
+        order[count++] = id;
+    }
+}
+
+void test_priority_aging(void) {
+    constexpr unsigned int iterations = 10;
+    unsigned int order[iterations + 2]{};
+    unsigned int count{ 0 };
+
+    // Without aging the background co-routine waits for the stream of priority 3 work.
+    {
+        scheduler_priority_aging<0> coro_scheduler;
+        count = 0;
+        auto background = record_priority(coro_scheduler, 1, 1, 1, order, count);
+        auto urgent = record_priority(coro_scheduler, 3, iterations, 3, order, count);
+        do {
+            (void)coro_scheduler.resume(schedule_by_priority{ 0 });
+        } while (!(background.done() && urgent.done()));
+        TEST_ASSERT_EQUAL_UINT(1, order[iterations]);
+        TEST_ASSERT_EQUAL_UINT(iterations, coro_scheduler.wait_stats(1).max_wait);
+    }
+
+    // With aging it is raised to priority 3 after two dispatches, and runs before the later priority 3 entry.
+    // The priority 5 work is beyond the aging limit and is never delayed.
+    {
+        scheduler_priority_aging<1, 2> coro_scheduler;
+        count = 0;
+        auto background = record_priority(coro_scheduler, 1, 1, 1, order, count);
+        auto urgent = record_priority(coro_scheduler, 3, iterations, 3, order, count);
+        auto critical = record_priority(coro_scheduler, 5, 1, 5, order, count);
+        do {
+            (void)coro_scheduler.resume(schedule_by_priority{ 0 });
+        } while (!(background.done() && urgent.done() && critical.done()));
+        TEST_ASSERT_EQUAL_UINT(5, order[0]);
+        TEST_ASSERT_EQUAL_UINT(3, order[1]);
+        TEST_ASSERT_EQUAL_UINT(1, order[2]);
+        TEST_ASSERT_EQUAL_UINT(1, coro_scheduler.wait_stats(1).count);
+        TEST_ASSERT_EQUAL_UINT(2, coro_scheduler.wait_stats(1).max_wait);
+        TEST_ASSERT_EQUAL_UINT(iterations, coro_scheduler.wait_stats(3).count);
+        TEST_ASSERT_EQUAL_UINT(0, coro_scheduler.wait_stats(5).max_wait);
+    }
+}
@@ -0,0 +1,329 @@
+/*
+   Unit tests for the SMP executor.
+
+   SPDX-License-Identifier: Unlicense
+
+   https://five-embeddev.com/
+
+*/
+
+#include <cstdint>
+#include <atomic>
+#include <coroutine>
+
+#include "unity.h"
+
+#include "coro/nop_task.hpp"
+#include "coro/smp_executor.hpp"
+
+/** Hart identity set by the test, to run all harts on one thread.
+    Wakeups are recorded, wait() calls on_wait to emulate another hart adding work.
+ */
+struct test_hart {
+    static inline std::size_t current{ 0 };
+    static inline std::uint32_t woken{ 0 };
+    static inline void (*on_wait)(void){ nullptr };
+    static std::size_t id(void) {
+        return current;
+    }
+    static void wake(std::size_t hart) {
+        woken |= std::uint32_t{ 1 } << hart;
+    }
+    static void wait(void) {
+        if (on_wait) {
+            on_wait();
+        }
+    }
+};
+
+template<class EXECUTOR>
+nop_task yield_loop(EXECUTOR& executor,
+                    const unsigned int run_count,
+                    std::atomic<unsigned int>& resume_count) {
+    for (unsigned int i = 0; i < run_count; i++) {
+        co_await executor;
+        resume_count.fetch_add(1, std::memory_order_relaxed);
+    }
+}
+
+void test_smp_executor_steal(void) {
+    smp_executor<test_hart, 2, 4> executor;
+    std::atomic<unsigned int> resume_count{ 0 };
+    test_hart::current = 0;
+
+    // All start on hart 0
+    auto t0 = yield_loop(executor, 2, resume_count);
+    auto t1 = yield_loop(executor, 2, resume_count);
+    TEST_ASSERT_FALSE(executor.empty());
+
+    // Hart 1 has no work, steals from hart 0, and is re-queued on hart 1
+    test_hart::current = 1;
+    TEST_ASSERT_TRUE(executor.run_one(1));
+    TEST_ASSERT_EQUAL_UINT(1, resume_count);
+    TEST_ASSERT_EQUAL_UINT(1, executor.stats(1).stolen);
+
+    // Hart 0 runs its own queue
+    test_hart::current = 0;
+    TEST_ASSERT_TRUE(executor.run_one(0));
+    TEST_ASSERT_EQUAL_UINT(0, executor.stats(0).stolen);
+
+    // Hart 1 runs the co-routine in its own queue, then steals the last from hart 0
+    test_hart::current = 1;
+    TEST_ASSERT_EQUAL_UINT(2, executor.resume());
+    TEST_ASSERT_TRUE(t0.done());
+    TEST_ASSERT_TRUE(t1.done());
+    TEST_ASSERT_EQUAL_UINT(4, resume_count);
+    TEST_ASSERT_EQUAL_UINT(2, executor.stats(1).stolen);
+    TEST_ASSERT_EQUAL_UINT(3, executor.stats(1).resumed);
+    TEST_ASSERT_EQUAL_UINT(1, executor.stats(0).resumed);
+    TEST_ASSERT_TRUE(executor.empty());
+    TEST_ASSERT_FALSE(executor.run_one(0));
+
+    // When all run queues are full the co-routine is not suspended.
+    test_hart::current = 0;
+    smp_executor<test_hart, 1, 2> single;
+    std::atomic<unsigned int> single_count{ 0 };
+    auto t2 = yield_loop(single, 1, single_count);
+    auto t3 = yield_loop(single, 1, single_count);
+    auto t4 = yield_loop(single, 1, single_count);
+    TEST_ASSERT_FALSE(t2.done());
+    TEST_ASSERT_FALSE(t3.done());
+    TEST_ASSERT_TRUE(t4.done());
+    TEST_ASSERT_EQUAL_UINT(2, single.resume());
+    TEST_ASSERT_TRUE(t2.done());
+    TEST_ASSERT_TRUE(t3.done());
+}
+
+template<class EXECUTOR>
+nop_task hart_hop(EXECUTOR& executor,
+                  std::size_t hart,
+                  std::size_t& resumed_on) {
+    co_await executor.resume_on(hart);
+    resumed_on = EXECUTOR::current_hart();
+}
+
+static smp_executor<test_hart, 2, 4>* resume_on_executor{ nullptr };
+
+void test_smp_executor_resume_on(void) {
+    smp_executor<test_hart, 2, 4> executor;
+    std::size_t resumed_on{ 99 };
+    test_hart::current = 0;
+    test_hart::woken = 0;
+
+    // Already on the hart, no switch
+    auto t0 = hart_hop(executor, 0, resumed_on);
+    TEST_ASSERT_TRUE(t0.done());
+    TEST_ASSERT_EQUAL_UINT(0, resumed_on);
+
+    // Pinned to hart 1, hart 0 can't steal it.
+    auto t1 = hart_hop(executor, 1, resumed_on);
+    TEST_ASSERT_FALSE(t1.done());
+    TEST_ASSERT_FALSE(executor.run_one(0));
+    // Hart 1 is busy, not woken
+    TEST_ASSERT_EQUAL_HEX(0, test_hart::woken);
+    test_hart::current = 1;
+    TEST_ASSERT_TRUE(executor.run_one(1));
+    TEST_ASSERT_TRUE(t1.done());
+    TEST_ASSERT_EQUAL_UINT(1, resumed_on);
+
+    // Hart 1 has work, idle() doesn't wait.
+    std::atomic<unsigned int> resume_count{ 0 };
+    auto t2 = yield_loop(executor, 1, resume_count);
+    executor.idle();
+    TEST_ASSERT_EQUAL_UINT(0, executor.stats(1).wakeups);
+    TEST_ASSERT_EQUAL_UINT(1, executor.resume());
+    TEST_ASSERT_TRUE(t2.done());
+
+    // Hart 1 waits, work added to busy hart 0 wakes hart 1 to steal it.
+    resume_on_executor = &executor;
+    test_hart::on_wait = []() {
+        resume_on_executor->insert(std::noop_coroutine(), 0);
+    };
+    executor.idle();
+    test_hart::on_wait = nullptr;
+    TEST_ASSERT_EQUAL_UINT(1, executor.stats(1).wakeups);
+    TEST_ASSERT_EQUAL_HEX(0x2, test_hart::woken);
+    TEST_ASSERT_EQUAL_UINT(1, executor.resume());
+    resume_on_executor = nullptr;
+}
+
+#ifdef HOST_EMULATION
+#include <chrono>
+
+#include "host/smp.hpp"
+#include "host/timer.hpp"
+#include "coro/scheduler.hpp"
+#include "coro/awaitable_timer.hpp"
+#include "coro/per_hart.hpp"
+
+using namespace std::literals::chrono_literals;
+
+using host_executor = smp_executor<riscv::smp::this_hart, 4, 16>;
+static host_executor* smp_test_executor{ nullptr };
+static std::atomic<unsigned int> smp_resume_count{ 0 };
+static constexpr unsigned int SMP_TASKS = 8;
+static constexpr unsigned int SMP_ITERATIONS = 100;
+
+static void smp_hart_loop(std::size_t hart) {
+    (void)hart;
+    while (smp_resume_count.load() < SMP_TASKS * SMP_ITERATIONS) {
+        if (smp_test_executor->resume() == 0) {
+            smp_test_executor->idle();
+        }
+    }
+    // Stop the harts that are idle.
+    smp_test_executor->wake_all();
+}
+
+void test_smp_executor_harts(void) {
+    host_executor executor;
+    smp_test_executor = &executor;
+    smp_resume_count = 0;
+    riscv::smp::emulated_harts = host_executor::hart_count;
+
+    // Created on hart 0, the other harts steal the work.
+    std::array<nop_task, SMP_TASKS> tasks;
+    for (auto& task : tasks) {
+        task = yield_loop(executor, SMP_ITERATIONS, smp_resume_count);
+    }
+    {
+        riscv::smp::secondary_harts harts(smp_hart_loop);
+        smp_hart_loop(riscv::smp::hart_id());
+    }
+
+    TEST_ASSERT_EQUAL_UINT(SMP_TASKS * SMP_ITERATIONS, smp_resume_count);
+    std::uint32_t resumed{ 0 };
+    for (std::size_t hart = 0; hart < host_executor::hart_count; hart++) {
+        resumed += executor.stats(hart).resumed;
+    }
+    TEST_ASSERT_EQUAL_UINT(SMP_TASKS * SMP_ITERATIONS, resumed);
+    for (const auto& task : tasks) {
+        TEST_ASSERT_TRUE(task.done());
+    }
+    TEST_ASSERT_TRUE(executor.empty());
+    smp_test_executor = nullptr;
+    for (auto& lines : host::hart_irq_lines) {
+        lines.reset();
+    }
+}
+
+template<class EXECUTOR>
+nop_task hart_hop_loop(EXECUTOR& executor,
+                       const unsigned int run_count,
+                       std::atomic<unsigned int>& resume_count,
+                       std::atomic<unsigned int>& wrong_hart) {
+    for (unsigned int i = 0; i < run_count; i++) {
+        const auto hart = i % EXECUTOR::hart_count;
+        co_await executor.resume_on(hart);
+        if (riscv::smp::hart_id() != hart) {
+            wrong_hart++;
+        }
+        resume_count.fetch_add(1, std::memory_order_relaxed);
+    }
+}
+
+void test_smp_executor_ipi(void) {
+    host_executor executor;
+    std::atomic<unsigned int> wrong_hart{ 0 };
+    smp_test_executor = &executor;
+    smp_resume_count = 0;
+    riscv::smp::emulated_harts = host_executor::hart_count;
+
+    // Each co-routine moves around the harts, the idle harts are woken by an IPI.
+    std::array<nop_task, SMP_TASKS> tasks;
+    for (auto& task : tasks) {
+        task = hart_hop_loop(executor, SMP_ITERATIONS, smp_resume_count, wrong_hart);
+    }
+    {
+        riscv::smp::secondary_harts harts(smp_hart_loop);
+        smp_hart_loop(riscv::smp::hart_id());
+    }
+
+    TEST_ASSERT_EQUAL_UINT(SMP_TASKS * SMP_ITERATIONS, smp_resume_count);
+    TEST_ASSERT_EQUAL_UINT(0, wrong_hart);
+    for (const auto& task : tasks) {
+        TEST_ASSERT_TRUE(task.done());
+    }
+    smp_test_executor = nullptr;
+    for (auto& lines : host::hart_irq_lines) {
+        lines.reset();
+    }
+}
+
+using hart_scheduler = scheduler_delay<host_clock>;
+static per_hart<hart_scheduler, riscv::smp::this_hart, 4>* hart_timers{ nullptr };
+static std::array<nop_task, 4> hart_timer_tasks;
+static std::array<unsigned int, 4> hart_timer_count;
+static std::atomic<unsigned int> wrong_timer_hart{ 0 };
+static constexpr unsigned int TIMER_ITERATIONS = 5;
+
+nop_task periodic_on_hart(hart_scheduler& scheduler,
+                          std::chrono::microseconds period,
+                          std::size_t hart) {
+    for (unsigned int i = 0; i < TIMER_ITERATIONS; i++) {
+        co_await scheduled_delay{ scheduler, period };
+        if (riscv::smp::hart_id() != hart) {
+            wrong_timer_hart++;
+        }
+        hart_timer_count[hart] = i + 1;
+    }
+}
+
+/** Each hart runs a periodic co-routine from its own scheduler and timer compare. */
+static void timer_hart_loop(std::size_t hart) {
+    auto& scheduler = hart_timers->local();
+    driver::timer<> mtimer{ hart };
+    hart_timer_tasks[hart] = periodic_on_hart(scheduler, std::chrono::microseconds(100 * (hart + 1)), hart);
+    while (!hart_timer_tasks[hart].done()) {
+        schedule_by_delay<host_clock> now;
+        auto [pending, next_wake] = scheduler.resume(now);
+        if (pending) {
+            mtimer.set_time_cmp(next_wake->delay());
+            riscv::smp::wait_ipi();
+        }
+    }
+}
+
+void test_smp_executor_hart_timers(void) {
+    per_hart<hart_scheduler, riscv::smp::this_hart, 4> timers;
+    hart_timers = &timers;
+    wrong_timer_hart = 0;
+    hart_timer_count = {};
+    riscv::smp::emulated_harts = 4;
+    riscv::csrs.mie.mti.set();
+
+    {
+        riscv::smp::secondary_harts harts(timer_hart_loop);
+        timer_hart_loop(riscv::smp::hart_id());
+    }
+
+    TEST_ASSERT_EQUAL_UINT(0, wrong_timer_hart);
+    for (std::size_t hart = 0; hart < 4; hart++) {
+        TEST_ASSERT_EQUAL_UINT(TIMER_ITERATIONS, hart_timer_count[hart]);
+        TEST_ASSERT_TRUE(hart_timer_tasks[hart].done());
+        // Each hart used its own timer compare
+        TEST_ASSERT_TRUE(host::hart_irq_lines[hart].mtimecmp() != host_clock::time_point::max());
+    }
+
+    riscv::csrs.mie.mti.clr();
+    hart_timers = nullptr;
+    for (auto& lines : host::hart_irq_lines) {
+        lines.reset();
+    }
+}
+
+#else
+
+void test_smp_executor_hart_timers(void) {
+    TEST_IGNORE_MESSAGE("Host emulation only");
+}
+
+void test_smp_executor_harts(void) {
+    TEST_IGNORE_MESSAGE("Host emulation only");
+}
+
+void test_smp_executor_ipi(void) {
+    TEST_IGNORE_MESSAGE("Host emulation only");
+}
+
+#endif
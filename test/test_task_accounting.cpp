@@ -0,0 +1,86 @@
+/*
+   Unit tests for per co-routine CPU time accounting.
+
+   SPDX-License-Identifier: Unlicense
+
+   https://five-embeddev.com/
+
+*/
+
+#include <cstdint>
+#include <coroutine>
+
+#include "unity.h"
+
+#include "debug/task_accounting.hpp"
+#include "coro/nop_task.hpp"
+
+static volatile unsigned int busy_count{ 0 };
+
+static void busy(unsigned int loops) {
+    for (unsigned int i = 0; i < loops; i++) {
+        busy_count = i;
+    }
+}
+
+void test_task_accounting(void) {
+    task_account_manager::reset();
+    int outer{ 0 };
+    int inner{ 0 };
+
+    // A co-routine resumed inside another is not counted in the outer co-routine.
+    for (unsigned int i = 0; i < 3; i++) {
+        const auto outer_begin = task_account_manager::start();
+        busy(1000);
+        const auto inner_begin = task_account_manager::start();
+        busy(100000);
+        task_account_manager::stop(inner_begin, &inner);
+        task_account_manager::stop(outer_begin, &outer);
+    }
+    task_account_manager::name(&inner, "inner");
+
+    const task_account* top[4];
+    TEST_ASSERT_EQUAL_UINT(2, task_account_manager::top(top));
+    TEST_ASSERT_EQUAL_PTR(&inner, top[0]->key);
+    TEST_ASSERT_EQUAL_STRING("inner", top[0]->name);
+    TEST_ASSERT_EQUAL_UINT(3, top[0]->resumes);
+    TEST_ASSERT_EQUAL_PTR(&outer, top[1]->key);
+    TEST_ASSERT_EQUAL_UINT(3, top[1]->resumes);
+    TEST_ASSERT_TRUE(top[0]->cycles > top[1]->cycles);
+}
+
+void test_task_accounting_overflow(void) {
+    task_account_manager::reset();
+    int keys[TASK_ACCOUNT_ENTRIES + 2];
+    for (auto& key : keys) {
+        task_account_manager::stop(task_account_manager::start(), &key);
+    }
+    // Co-routines that don't fit share the last entry.
+    const auto& accounts = task_account_manager::accounts();
+    TEST_ASSERT_EQUAL_PTR(&keys[0], accounts[0].key);
+    TEST_ASSERT_EQUAL_UINT(1, accounts[0].resumes);
+    TEST_ASSERT_EQUAL_UINT(3, accounts[TASK_ACCOUNT_ENTRIES - 1].resumes);
+
+    // Only the largest are returned.
+    const task_account* top[2];
+    TEST_ASSERT_EQUAL_UINT(2, task_account_manager::top(top));
+    TEST_ASSERT_TRUE(top[0]->cycles >= top[1]->cycles);
+}
+
+static nop_task named_task() {
+    co_await task_account_name{ "named" };
+}
+
+void test_task_accounting_name(void) {
+    task_account_manager::reset();
+    auto task = named_task();
+    TEST_ASSERT_TRUE(task.done());
+#if defined(ENABLE_TASK_ACCOUNTING)
+    TEST_ASSERT_NOT_NULL(task_account_manager::accounts()[0].key);
+    TEST_ASSERT_EQUAL_STRING("named", task_account_manager::accounts()[0].name);
+#else
+    // Naming is a no-op, the accounts are not used.
+    TEST_ASSERT_NULL(task_account_manager::accounts()[0].key);
+#endif
+    task_account_manager::reset();
+}
@@ -31,8 +31,14 @@
 #include "riscv/scheduler-timer-mtimer.hpp"
 #endif
 
-#ifdef HOST_EMULATION
-using test_clock = std::chrono::steady_clock;
+#if defined(HOST_EMULATION) && defined(HOST_VIRTUAL_TIME)
+using test_clock = host_clock;
+void sleep_for(test_clock::duration delay) {
+    // Fast forward to the next wakeup
+    test_clock::advance(delay);
+}
+#elif defined(HOST_EMULATION)
+using test_clock = host_clock;
 void sleep_for(test_clock::duration delay) {
     std::this_thread::sleep_for(delay);
 }
@@ -176,3 +182,51 @@ void test_nested_coroutines(void) {
 
     TEST_ASSERT_EQUAL_HEX(0x77, cover_flags);
 }
+
+template<typename SCHEDULER>
+nop_task record_wake(
+    SCHEDULER& scheduler,
+    std::chrono::microseconds delay,
+    unsigned int id,
+    unsigned int* order,
+    unsigned int& count,
+    test_clock::duration* wake_time) {
+    const auto start_time = test_clock::now();
+    co_await scheduled_delay{ scheduler, delay };
+    wake_time[count] = test_clock::now() - start_time;
+    order[count++] = id;
+}
+
+void test_wake_order(void) {
+    scheduler_delay<test_clock> coro_scheduler;
+    unsigned int order[3]{};
+    test_clock::duration wake_time[3]{};
+    unsigned int count{ 0 };
+
+    auto task1 = record_wake(coro_scheduler, 30ms, 1, order, count, wake_time);
+    auto task2 = record_wake(coro_scheduler, 20ms, 2, order, count, wake_time);
+    auto task3 = record_wake(coro_scheduler, 50ms, 3, order, count, wake_time);
+
+    do {
+        schedule_by_delay<test_clock> now;
+        auto [pending, next_wake] = coro_scheduler.resume(now);
+        if (next_wake) {
+            sleep_for(next_wake->delay());
+        }
+    } while (!(task1.done() && task2.done() && task3.done()));
+
+    // Woken in deadline order, not after the deadline of the next co-routine.
+    TEST_ASSERT_EQUAL_UINT(3, count);
+    TEST_ASSERT_EQUAL_UINT(2, order[0]);
+    TEST_ASSERT_EQUAL_UINT(1, order[1]);
+    TEST_ASSERT_EQUAL_UINT(3, order[2]);
+    TEST_ASSERT_TRUE(wake_time[0] >= 20ms && wake_time[0] < 30ms);
+    TEST_ASSERT_TRUE(wake_time[1] >= 30ms && wake_time[1] < 50ms);
+    TEST_ASSERT_TRUE(wake_time[2] >= 50ms);
+#if defined(HOST_EMULATION) && defined(HOST_VIRTUAL_TIME)
+    // Virtual time is advanced to each deadline.
+    TEST_ASSERT_TRUE(wake_time[0] < 20ms + 1us);
+    TEST_ASSERT_TRUE(wake_time[1] < 30ms + 1us);
+    TEST_ASSERT_TRUE(wake_time[2] < 50ms + 1us);
+#endif
+}
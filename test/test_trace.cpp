@@ -0,0 +1,91 @@
+/*
+   Unit tests for the binary event trace.
+
+   The categories are selected with TRACE_RECORD_IF, so the tests don't
+   depend on the TRACE_CATEGORIES build setting.
+
+   SPDX-License-Identifier: Unlicense
+
+   https://five-embeddev.com/
+
+*/
+
+#include <cstdint>
+
+#include "unity.h"
+
+#include "debug/trace.hpp"
+
+void test_trace_decode(void) {
+    trace_log_manager::reset();
+    TRACE_RECORD_IF(TRACE_CATEGORY_ALL, trace_event::isr_enter, 7);
+    TRACE_RECORD_IF(TRACE_CATEGORY_ALL, trace_event::coro_resume, 0x12345678);
+    TRACE_RECORD_IF(TRACE_CATEGORY_ALL, trace_event::coro_suspend, 0x12345678);
+    TRACE_RECORD_IF(TRACE_CATEGORY_ALL, trace_event::isr_exit, 7);
+
+    const trace_event expect[] = { trace_event::isr_enter, trace_event::coro_resume, trace_event::coro_suspend, trace_event::isr_exit };
+    const std::uint64_t expect_value[] = { 7, 0x12345678, 0x12345678, 7 };
+    unsigned int count{ 0 };
+    std::uint64_t last{ 0 };
+    trace_log_manager::decode(trace_log_manager::log(), [&](trace_event event, std::uint64_t t, std::uint64_t value) {
+        TEST_ASSERT_TRUE(count < 4);
+        TEST_ASSERT_TRUE(event == expect[count]);
+        TEST_ASSERT_EQUAL_UINT64(expect_value[count], value);
+        TEST_ASSERT_TRUE(t >= last);
+        last = t;
+        count++;
+    });
+    TEST_ASSERT_EQUAL_UINT(4, count);
+    // A sync and 4 events, each with a 1 byte id and small delta.
+    TEST_ASSERT_TRUE(trace_log_manager::log().head < 32);
+}
+
+void test_trace_wrap(void) {
+    trace_log_manager::reset();
+    constexpr std::uint32_t events = 4 * TRACE_BUFFER_SIZE;
+    for (std::uint32_t i = 0; i < events; i++) {
+        TRACE_RECORD_IF(TRACE_CATEGORY_ALL, trace_event::scheduler_wake, i);
+    }
+    TEST_ASSERT_TRUE(trace_log_manager::log().head > TRACE_BUFFER_SIZE);
+
+    // The oldest events were overwritten, the decoded events are the most recent in order.
+    unsigned int count{ 0 };
+    std::uint64_t next{ 0 };
+    trace_log_manager::decode(trace_log_manager::log(), [&](trace_event event, std::uint64_t, std::uint64_t value) {
+        TEST_ASSERT_TRUE(event == trace_event::scheduler_wake);
+        if (count > 0) {
+            TEST_ASSERT_EQUAL_UINT64(next, value);
+        }
+        next = value + 1;
+        count++;
+    });
+    TEST_ASSERT_EQUAL_UINT64(events, next);
+    TEST_ASSERT_TRUE(count > TRACE_BUFFER_SIZE / 8);
+    trace_log_manager::reset();
+}
+
+void test_trace_categories(void) {
+    trace_log_manager::reset();
+    unsigned int evaluated{ 0 };
+    auto payload = [&evaluated](unsigned int value) {
+        evaluated++;
+        return value;
+    };
+    TRACE_RECORD_IF(TRACE_CATEGORY_ISR, trace_event::coro_resume, payload(1));
+    TRACE_RECORD_IF(TRACE_CATEGORY_ISR, trace_event::scheduler_wake, payload(2));
+    TRACE_RECORD_IF(TRACE_CATEGORY_ISR, trace_event::timestamp, payload(3));
+    // Disabled categories don't record or evaluate the payload.
+    TEST_ASSERT_EQUAL_UINT(0, evaluated);
+    TEST_ASSERT_EQUAL_UINT32(0, trace_log_manager::log().head);
+
+    TRACE_RECORD_IF(TRACE_CATEGORY_ISR, trace_event::isr_enter, payload(4));
+    TEST_ASSERT_EQUAL_UINT(1, evaluated);
+    unsigned int count{ 0 };
+    trace_log_manager::decode(trace_log_manager::log(), [&](trace_event event, std::uint64_t, std::uint64_t value) {
+        TEST_ASSERT_TRUE(event == trace_event::isr_enter);
+        TEST_ASSERT_EQUAL_UINT64(4, value);
+        count++;
+    });
+    TEST_ASSERT_EQUAL_UINT(1, count);
+    trace_log_manager::reset();
+}
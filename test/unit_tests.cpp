@@ -13,10 +13,52 @@ extern void test_static_list_insert_remove();
 extern void test_single_coroutine();
 extern void test_interleaving_coroutines();
 extern void test_nested_coroutines();
+extern void test_wake_order();
 extern void test_single_prio_coroutine();
+extern void test_priority_aging();
 extern void test_single_unordered_coroutine();
 extern void test_double_unordered_coroutine();
 extern void test_double_unordered_coroutine_blocking_patterns();
+extern void test_event_group_wait_any();
+extern void test_event_group_wait_all();
+extern void test_event_group_ready();
+extern void test_event_group_multiple_waiters();
+extern void test_latency_stats();
+extern void test_latency_log();
+extern void test_deferred_queue_order();
+extern void test_deferred_queue_resume();
+extern void test_execution_levels_order();
+extern void test_execution_levels_preempt();
+extern void test_execution_levels_lock();
+extern void test_host_wfi_timer();
+extern void test_host_wfi_inject();
+extern void test_host_irq_masking();
+extern void test_host_irq_sources();
+extern void test_host_irq_thread();
+extern void test_smp_executor_steal();
+extern void test_smp_executor_harts();
+extern void test_smp_executor_resume_on();
+extern void test_smp_executor_ipi();
+extern void test_smp_executor_hart_timers();
+extern void test_deadline_order();
+extern void test_deadline_mixed_rate();
+extern void test_deadline_monitor();
+extern void test_executor_order();
+extern void test_executor_isr();
+extern void test_trace_decode();
+extern void test_trace_wrap();
+extern void test_trace_categories();
+extern void test_task_accounting();
+extern void test_task_accounting_overflow();
+extern void test_task_accounting_name();
+extern void test_pc_sampler();
+extern void test_pc_sampler_full();
+extern void test_pc_sampler_sleep();
+extern void test_pc_sampler_idle();
+extern void test_pmu();
+extern void test_jitter_buckets();
+extern void test_jitter_percentile();
+extern void test_jitter_log();
 
 void setUp(void) {
     // There is no global state for the co-routine implementation.
@@ -33,10 +75,52 @@ int runUnityTests(void) {
     RUN_TEST(test_single_coroutine);
     RUN_TEST(test_interleaving_coroutines);
     RUN_TEST(test_nested_coroutines);
+    RUN_TEST(test_wake_order);
     RUN_TEST(test_single_prio_coroutine);
+    RUN_TEST(test_priority_aging);
     RUN_TEST(test_single_unordered_coroutine);
     RUN_TEST(test_double_unordered_coroutine);
     RUN_TEST(test_double_unordered_coroutine_blocking_patterns);
+    RUN_TEST(test_event_group_wait_any);
+    RUN_TEST(test_event_group_wait_all);
+    RUN_TEST(test_event_group_ready);
+    RUN_TEST(test_event_group_multiple_waiters);
+    RUN_TEST(test_latency_stats);
+    RUN_TEST(test_latency_log);
+    RUN_TEST(test_deferred_queue_order);
+    RUN_TEST(test_deferred_queue_resume);
+    RUN_TEST(test_execution_levels_order);
+    RUN_TEST(test_execution_levels_preempt);
+    RUN_TEST(test_execution_levels_lock);
+    RUN_TEST(test_host_wfi_timer);
+    RUN_TEST(test_host_wfi_inject);
+    RUN_TEST(test_host_irq_masking);
+    RUN_TEST(test_host_irq_sources);
+    RUN_TEST(test_host_irq_thread);
+    RUN_TEST(test_smp_executor_steal);
+    RUN_TEST(test_smp_executor_harts);
+    RUN_TEST(test_smp_executor_resume_on);
+    RUN_TEST(test_smp_executor_ipi);
+    RUN_TEST(test_smp_executor_hart_timers);
+    RUN_TEST(test_deadline_order);
+    RUN_TEST(test_deadline_mixed_rate);
+    RUN_TEST(test_deadline_monitor);
+    RUN_TEST(test_executor_order);
+    RUN_TEST(test_executor_isr);
+    RUN_TEST(test_trace_decode);
+    RUN_TEST(test_trace_wrap);
+    RUN_TEST(test_trace_categories);
+    RUN_TEST(test_task_accounting);
+    RUN_TEST(test_task_accounting_overflow);
+    RUN_TEST(test_task_accounting_name);
+    RUN_TEST(test_pc_sampler);
+    RUN_TEST(test_pc_sampler_full);
+    RUN_TEST(test_pc_sampler_sleep);
+    RUN_TEST(test_pc_sampler_idle);
+    RUN_TEST(test_pmu);
+    RUN_TEST(test_jitter_buckets);
+    RUN_TEST(test_jitter_percentile);
+    RUN_TEST(test_jitter_log);
     return UNITY_END();
 }
 
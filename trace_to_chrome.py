@@ -0,0 +1,125 @@
+#!/usr/bin/env python3
+"""Decode a binary event trace (include/debug/trace.hpp) to Chrome trace JSON.
+
+The input is a dump of trace_log_manager::log_, e.g. from the host with
+`main.elf --trace trace.bin`, or from GDB on the target with:
+
+    dump binary value trace.bin trace_log_manager::log_
+
+Open the output in https://ui.perfetto.dev or chrome://tracing.
+"""
+
+import argparse
+import json
+import struct
+import sys
+
+MAGIC = 0x31435254
+HEADER = struct.Struct("<8I")
+
+# Event ids, keep in sync with trace_event in include/debug/trace.hpp
+EVENTS = [
+    "sync",
+    "timestamp",
+    "coro_pending",
+    "next_wake_delay",
+    "scheduler_insert",
+    "scheduler_wake",
+    "coro_resume",
+    "coro_suspend",
+    "isr_enter",
+    "isr_exit",
+    "wake_jitter",
+]
+
+
+def read_leb(data, pos):
+    """Read an unsigned LEB128 value at pos (in bytes written), return (value, pos)."""
+    value = 0
+    shift = 0
+    while True:
+        byte = data[pos % len(data)]
+        pos += 1
+        value |= (byte & 0x7F) << shift
+        shift += 7
+        if not (byte & 0x80) or shift >= 64:
+            return value, pos
+
+
+def decode(raw):
+    """Yield (event name, timestamp in ticks, payload), oldest first."""
+    magic, size, ticks_per_us, head, *sync = HEADER.unpack_from(raw)
+    if magic != MAGIC:
+        raise ValueError("not a trace dump, magic is 0x%08x" % magic)
+    data = raw[HEADER.size:HEADER.size + size]
+    oldest = max(head - size, 0)
+    valid = [s for s in sync if oldest <= s < head]
+    if not valid:
+        return ticks_per_us, []
+    pos = min(valid)
+    events = []
+    t = 0
+    while pos < head:
+        event = data[pos % size]
+        pos += 1
+        delta, pos = read_leb(data, pos)
+        value, pos = read_leb(data, pos)
+        if event == 0:
+            t = value
+            continue
+        t += delta
+        name = EVENTS[event] if event < len(EVENTS) else "event_%d" % event
+        events.append((name, t, value))
+    return ticks_per_us, events
+
+
+def to_chrome(events, ticks_per_us, pid=0):
+    """Convert events to the Chrome trace event format.
+    Each co-routine is a thread, named by its handle, ISRs are on thread 0.
+    """
+    out = []
+    start = events[0][1] if events else 0
+    for name, t, value in events:
+        ts = (t - start) / ticks_per_us
+        if name == "coro_resume":
+            out.append({"name": "run", "ph": "B", "ts": ts, "pid": pid, "tid": value})
+        elif name == "coro_suspend":
+            out.append({"name": "run", "ph": "E", "ts": ts, "pid": pid, "tid": value})
+        elif name == "isr_enter":
+            out.append({"name": "isr %d" % (value & 0xFF), "ph": "B", "ts": ts, "pid": pid, "tid": 0})
+        elif name == "isr_exit":
+            out.append({"name": "isr %d" % (value & 0xFF), "ph": "E", "ts": ts, "pid": pid, "tid": 0})
+        elif name == "scheduler_insert":
+            out.append({"name": "insert", "ph": "i", "s": "t", "ts": ts, "pid": pid, "tid": value})
+        elif name == "scheduler_wake":
+            out.append({"name": "wake", "ph": "i", "s": "p", "ts": ts, "pid": pid, "tid": 0,
+                        "args": {"scheduler": "0x%x" % value}})
+        else:
+            out.append({"name": name, "ph": "C", "ts": ts, "pid": pid, "args": {name: value}})
+    return {"traceEvents": out, "displayTimeUnit": "ns"}
+
+
+def main():
+    parser = argparse.ArgumentParser(description=__doc__, formatter_class=argparse.RawDescriptionHelpFormatter)
+    parser.add_argument("dump", help="binary dump of trace_log_manager::log_")
+    parser.add_argument("-o", "--output", help="output JSON file (default stdout)")
+    parser.add_argument("--ticks-per-us", type=float,
+                        help="override the timestamp ticks per microsecond, e.g. the core clock in MHz for mcycle")
+    args = parser.parse_args()
+
+    with open(args.dump, "rb") as f:
+        raw = f.read()
+    ticks_per_us, events = decode(raw)
+    if args.ticks_per_us:
+        ticks_per_us = args.ticks_per_us
+    trace = to_chrome(events, ticks_per_us or 1)
+    if args.output:
+        with open(args.output, "w") as f:
+            json.dump(trace, f)
+    else:
+        json.dump(trace, sys.stdout)
+    return 0
+
+
+if __name__ == "__main__":
+    sys.exit(main())